@@ -4,6 +4,10 @@
 
 #include <iostream>
 #include <vector>
+#include <algorithm>
+#include <functional>
+
+#include "helpers/Benchmark.hpp"
 
 
 #pragma mark - Helpers
@@ -275,10 +279,44 @@ void testSearchForRightmostElement() {
 }
 
 
+#pragma mark - Benchmark
+/// Each search vs. `std::lower_bound` / `std::upper_bound`, for random targets in a sorted array with duplicates.
+void benchmarkSearches(benchmark::Runner& runner) {
+    const auto elementsCount = benchmark::scaled(1000000);
+    const auto queriesCount = benchmark::scaled(100000);
+    const auto nums = benchmark::generateSortedIntegers(elementsCount, 0, static_cast<int>(elementsCount / 4));
+    const auto targets = benchmark::generateRandomIntegers(queriesCount, 0, static_cast<int>(elementsCount / 4), 43);
+
+    auto runSearch = [&](const std::string& variant, const std::function<int(const std::vector<int>&, const int)>& f) {
+        runner.run("binary_search", variant, queriesCount, [&]() {
+            long long checksum = 0;
+            for (const auto target: targets) {
+                checksum += f(nums, target);
+            }
+            return checksum;
+        });
+    };
+
+    runSearch("searchForANumber", searchForANumber);
+    runSearch("searchForLeftmostElement", searchForLeftmostElement);
+    runSearch("searchForRightmostElement", searchForRightmostElement);
+    runSearch("std::lower_bound", [](const std::vector<int>& nums, const int target) {
+        return static_cast<int>(std::lower_bound(nums.begin(), nums.end(), target) - nums.begin());
+    });
+    runSearch("std::upper_bound", [](const std::vector<int>& nums, const int target) {
+        return static_cast<int>(std::upper_bound(nums.begin(), nums.end(), target) - nums.begin());
+    });
+}
+
+
 int main() {
     testSearchForANumber();
     testSearchForLeftmostElement();
     testSearchForRightmostElement();
 
+    auto runner = benchmark::Runner();
+    benchmarkSearches(runner);
+    runner.writeFromEnvironment();
+
     return 0;
 }
@@ -6,11 +6,20 @@
 #include <vector>
 #include <unordered_map>
 #include <set>
+#include <map>
+#include <algorithm>
+#include <functional>
 #include <queue>
 #include <utility>    // std::pair
+#include <climits>
+#include <random>
+#include <string>
+#include <stdexcept>
 
 #include "helpers/Operators.hpp"
 #include "helpers/terminal_format.h"
+#include "helpers/Benchmark.hpp"
+#include "helpers/PerfCounters.hpp"
 
 
 #pragma mark - Helpers
@@ -28,6 +37,30 @@ inline std::vector<std::unordered_map<int, int>> createGraph(const int nodeCount
 }
 
 
+/// Connected random graph: a random spanning tree, then random extra edges.
+void generateRandomGraph(const int nodeCount, const long long edgeCount, std::vector<std::pair<int, int>>& edges, std::vector<int>& distances) {
+    auto generator = std::mt19937(42);
+    auto nodeDistribution = std::uniform_int_distribution<int>(0, nodeCount - 1);
+    auto distanceDistribution = std::uniform_int_distribution<int>(1, 1000);
+
+    edges.clear();
+    distances.clear();
+    for (int node = 1; node < nodeCount; node += 1) {
+        edges.emplace_back(std::uniform_int_distribution<int>(0, node - 1)(generator), node);
+    }
+    while (static_cast<long long>(edges.size()) < edgeCount) {
+        const int from = nodeDistribution(generator);
+        const int to = nodeDistribution(generator);
+        if (from != to) {
+            edges.emplace_back(from, to);
+        }
+    }
+    for (size_t i = 0; i < edges.size(); i += 1) {
+        distances.push_back(distanceDistribution(generator));
+    }
+}
+
+
 #pragma mark - 1. Balanced search tree
 std::vector<int> dijkstraRedBlackTree(const int nodeCount, const std::vector<std::pair<int, int>>& edges, const std::vector<int>& distances, const int sourceNode) {
     // Create graph.
@@ -113,6 +146,8 @@ std::vector<int> dijkstraHeap(const int nodeCount, const std::vector<std::pair<i
         }
     }
 
+    // Until the end of the function.
+    PERF_COUNTERS_SCOPE("dijkstraHeap loop");
     while (!unvisitedNodes.empty()) {
         const auto [currentNode, currentDistance] = unvisitedNodes.top();
         unvisitedNodes.pop();
@@ -144,6 +179,150 @@ std::vector<int> dijkstraHeap(const int nodeCount, const std::vector<std::pair<i
 }
 
 
+#pragma mark - 3. Incremental updates
+/*
+ * Keeps the distances and the shortest-path tree of a previous run, and repairs them when an edge weight changes (Ramalingam-Reps style).
+ *
+ * - Decrease (or new edge): if it shortens the path to 1 end, run Dijkstra from there. It only goes as far as distances improve.
+ * - Increase of a non-tree edge: nothing changes.
+ * - Increase of a tree edge: only the subtree below it can get longer. Reset it, seed each of its nodes with its best neighbor outside, and run Dijkstra in it.
+ *
+ * Either way the work is about the changed region and its neighbors, not the whole graph. The graph is built once.
+ *
+ * Distances are `int`: every weight must be in [0, `getMaxWeight(nodeCount)`], so that no path of at most `nodeCount` edges overflows.
+ */
+class DynamicShortestPaths {
+private:
+    std::vector<std::unordered_map<int, int>> neighborsGraph;
+    std::vector<int> returnValue;
+    /// Shortest-path tree: previous node on the path from the source, -1 for the source and unreachable nodes.
+    std::vector<int> parents;
+
+    using HeapEntry = std::pair<int, int>;    // (distance, vertex)
+    std::priority_queue<HeapEntry, std::vector<HeapEntry>, std::greater<HeapEntry>> heap;
+    /// Subtree being repaired after an increase.
+    std::vector<bool> isAffected;
+
+public:
+    DynamicShortestPaths(const int nodeCount, const std::vector<std::pair<int, int>>& edges, const std::vector<int>& distances, const int sourceNode): neighborsGraph(createGraph(nodeCount, edges, distances)), returnValue(nodeCount, INT_MAX), parents(nodeCount, -1), isAffected(nodeCount, false) {
+        returnValue[sourceNode] = 0;
+        heap.emplace(0, sourceNode);
+        settle();
+    }
+
+public:
+    /// Largest weight for which no path length (or relaxation of 1 more edge) overflows `int`.
+    static int getMaxWeight(const int nodeCount) {
+        return INT_MAX / std::max(1, nodeCount);
+    }
+
+    const std::vector<int>& getDistances() const {
+        return returnValue;
+    }
+
+    const std::vector<int>& getParents() const {
+        return parents;
+    }
+
+    /**
+     * Sets the weight of the undirected edge (`node1`, `node2`), adding it if needed, and repairs the distances.
+     *
+     * @param weight In [0, `getMaxWeight(nodeCount)`].
+     * @return Nodes whose distance was recomputed.
+     */
+    int setEdgeWeight(const int node1, const int node2, const int weight) {
+        if ((weight < 0) || (weight > getMaxWeight(static_cast<int>(neighborsGraph.size())))) {
+            throw std::invalid_argument("DynamicShortestPaths: the weight must be in [0, getMaxWeight(nodeCount)]");
+        }
+        const auto found = neighborsGraph[node1].find(node2);
+        const bool isIncrease = (found != neighborsGraph[node1].end()) && (weight > found->second);
+        neighborsGraph[node1][node2] = weight;
+        neighborsGraph[node2][node1] = weight;
+
+        if (isIncrease) {
+            if (parents[node2] == node1) {
+                return repairSubtree(node2);
+            } else if (parents[node1] == node2) {
+                return repairSubtree(node1);
+            }
+            // Not in the tree: no shortest path uses it.
+            return 0;
+        }
+
+        // Decrease: at most 1 end gets closer.
+        relax(node1, node2, weight);
+        relax(node2, node1, weight);
+        return settle();
+    }
+
+private:
+    void relax(const int from, const int to, const int weight) {
+        if ((returnValue[from] != INT_MAX) && (returnValue[from] + weight < returnValue[to])) {
+            returnValue[to] = returnValue[from] + weight;
+            parents[to] = from;
+            heap.emplace(returnValue[to], to);
+        }
+    }
+
+    /// Dijkstra from the nodes in `heap`. Returns the nodes settled.
+    int settle() {
+        int settledCount = 0;
+        while (!heap.empty()) {
+            const auto [currentDistance, currentNode] = heap.top();
+            heap.pop();
+
+            if (currentDistance > returnValue[currentNode]) {
+                // This is an outdated "garbage" node.
+                continue;
+            }
+            settledCount += 1;
+
+            for (const auto& [neighbor, distance]: neighborsGraph[currentNode]) {
+                relax(currentNode, neighbor, distance);
+            }
+        }
+        return settledCount;
+    }
+
+    /// The tree edge to `subtreeRoot` got longer.
+    int repairSubtree(const int subtreeRoot) {
+        // 1. Collect the subtree: children are the neighbors whose parent is the current node.
+        auto subtree = std::vector<int>({subtreeRoot});
+        isAffected[subtreeRoot] = true;
+        for (size_t i = 0; i < subtree.size(); i += 1) {
+            const int node = subtree[i];
+            for (const auto& neighborAndDistance: neighborsGraph[node]) {
+                const int neighbor = neighborAndDistance.first;
+                if ((parents[neighbor] == node) && (!isAffected[neighbor])) {
+                    isAffected[neighbor] = true;
+                    subtree.push_back(neighbor);
+                }
+            }
+        }
+
+        // 2. Outside the subtree, distances are still right: start each node from its best neighbor outside.
+        for (const int node: subtree) {
+            returnValue[node] = INT_MAX;
+            parents[node] = -1;
+        }
+        for (const int node: subtree) {
+            for (const auto& [neighbor, distance]: neighborsGraph[node]) {
+                if (!isAffected[neighbor]) {
+                    relax(neighbor, node, distance);
+                }
+            }
+        }
+        for (const int node: subtree) {
+            isAffected[node] = false;
+        }
+
+        // 3. Nodes outside can't get closer: this stays in the subtree.
+        settle();
+        return static_cast<int>(subtree.size());
+    }
+};
+
+
 void test(const int nodeCount, const std::vector<std::pair<int, int>>& edges, const std::vector<int>& distances, const int sourceNode, const std::vector<int>& expectedResult) {
 //    auto result = dijkstraRedBlackTree(nodeCount, edges, distances, sourceNode);
     auto result = dijkstraHeap(nodeCount, edges, distances, sourceNode);
@@ -155,6 +334,120 @@ void test(const int nodeCount, const std::vector<std::pair<int, int>>& edges, co
 }
 
 
+/// Random weight changes (increases, decreases, new edges), each checked against `dijkstraHeap` from scratch.
+void testDynamicShortestPaths(const int nodeCount, const int averageDegree, const int updatesCount) {
+    auto edges = std::vector<std::pair<int, int>>();
+    auto distances = std::vector<int>();
+    generateRandomGraph(nodeCount, static_cast<long long>(nodeCount) * averageDegree / 2, edges, distances);
+    // `createGraph` keeps the last weight of a repeated edge: so does `edgeIndices`.
+    auto edgeIndices = std::map<std::pair<int, int>, size_t>();
+    for (size_t i = 0; i < edges.size(); i += 1) {
+        edgeIndices[std::minmax(edges[i].first, edges[i].second)] = i;
+    }
+
+    auto dynamicShortestPaths = DynamicShortestPaths(nodeCount, edges, distances, 0);
+    bool isCorrect = (dynamicShortestPaths.getDistances() == dijkstraHeap(nodeCount, edges, distances, 0));
+
+    auto generator = std::mt19937(nodeCount);
+    auto nodeDistribution = std::uniform_int_distribution<int>(0, nodeCount - 1);
+    auto kindDistribution = std::uniform_int_distribution<int>(0, 3);
+    // Below `DynamicShortestPaths::getMaxWeight` for these sizes; also keeps `oldWeight * 20` in `int`.
+    const int maxWeight = std::min(1000000, DynamicShortestPaths::getMaxWeight(nodeCount));
+    for (int i = 0; (i < updatesCount) && isCorrect; i += 1) {
+        int node1 = 0;
+        int node2 = 0;
+        int weight = 0;
+        const int kind = kindDistribution(generator);
+        if (kind == 0) {
+            // New edge (or an existing one, by chance).
+            do {
+                node1 = nodeDistribution(generator);
+                node2 = nodeDistribution(generator);
+            } while (node1 == node2);
+            weight = std::uniform_int_distribution<int>(1, 1000)(generator);
+        } else {
+            const auto& edge = edges[std::uniform_int_distribution<size_t>(0, edges.size() - 1)(generator)];
+            node1 = edge.first;
+            node2 = edge.second;
+            const int oldWeight = distances[edgeIndices[std::minmax(node1, node2)]];
+            // Decrease, increase, large increase. Capped: the same edge can be picked again and again.
+            weight = (kind == 1)? std::max(1, oldWeight / 2): std::min((kind == 2)? (oldWeight + 100): (oldWeight * 20), maxWeight);
+        }
+
+        const auto key = std::minmax(node1, node2);
+        if (edgeIndices.count(key)) {
+            distances[edgeIndices[key]] = weight;
+        } else {
+            edgeIndices[key] = edges.size();
+            edges.emplace_back(node1, node2);
+            distances.push_back(weight);
+        }
+
+        dynamicShortestPaths.setEdgeWeight(node1, node2, weight);
+        isCorrect = (dynamicShortestPaths.getDistances() == dijkstraHeap(nodeCount, edges, distances, 0));
+    }
+
+    if (isCorrect) {
+        std::cout << terminal_format::OK_GREEN << "[Correct]" << terminal_format::ENDC << " DynamicShortestPaths " << nodeCount << " nodes, " << updatesCount << " updates" << std::endl;
+    } else {
+        std::cout << terminal_format::FAIL << "[Wrong] " << terminal_format::ENDC << "DynamicShortestPaths " << nodeCount << " nodes, " << updatesCount << " updates" << std::endl;
+    }
+}
+
+
+#pragma mark - Benchmark
+/// `dijkstraHeap` vs. `dijkstraRedBlackTree`, with `averageDegree` edges per node.
+void benchmarkDijkstra(benchmark::Runner& runner, const int averageDegree) {
+    const auto nodeCount = static_cast<int>(benchmark::scaled(10000));
+    auto edges = std::vector<std::pair<int, int>>();
+    auto distances = std::vector<int>();
+    generateRandomGraph(nodeCount, static_cast<long long>(nodeCount) * averageDegree / 2, edges, distances);
+
+    const auto group = "dijkstra (degree " + std::to_string(averageDegree) + ")";
+    runner.run(group, "dijkstraHeap", static_cast<long long>(edges.size()), [&]() {
+        return dijkstraHeap(nodeCount, edges, distances, 0).back();
+    });
+    runner.run(group, "dijkstraRedBlackTree", static_cast<long long>(edges.size()), [&]() {
+        return dijkstraRedBlackTree(nodeCount, edges, distances, 0).back();
+    });
+
+    if (dijkstraHeap(nodeCount, edges, distances, 0) != dijkstraRedBlackTree(nodeCount, edges, distances, 0)) {
+        std::cout << terminal_format::FAIL << "[Wrong] " << terminal_format::ENDC << "dijkstraHeap and dijkstraRedBlackTree disagree" << std::endl;
+    }
+}
+
+
+/// `DynamicShortestPaths::setEdgeWeight` vs. `dijkstraHeap` from scratch, on random changes of existing edges.
+void benchmarkDynamicShortestPaths(benchmark::Runner& runner) {
+    const auto nodeCount = static_cast<int>(benchmark::scaled(100000));
+    const int updatesCount = 1000;
+    auto edges = std::vector<std::pair<int, int>>();
+    auto distances = std::vector<int>();
+    generateRandomGraph(nodeCount, static_cast<long long>(nodeCount) * 4, edges, distances);
+
+    auto dynamicShortestPaths = DynamicShortestPaths(nodeCount, edges, distances, 0);
+    auto generator = std::mt19937(42);
+    auto edgeDistribution = std::uniform_int_distribution<size_t>(0, edges.size() - 1);
+    auto weightDistribution = std::uniform_int_distribution<int>(1, 1000);
+    long long recomputedCount = 0;
+    long long updatesDone = 0;
+
+    runner.run("dynamic_sssp", "dijkstraHeap (1 update)", 1, [&]() {
+        return dijkstraHeap(nodeCount, edges, distances, 0).back();
+    });
+    runner.run("dynamic_sssp", "DynamicShortestPaths::setEdgeWeight", updatesCount, [&]() {
+        for (int i = 0; i < updatesCount; i += 1) {
+            const auto& edge = edges[edgeDistribution(generator)];
+            recomputedCount += dynamicShortestPaths.setEdgeWeight(edge.first, edge.second, weightDistribution(generator));
+        }
+        updatesDone += updatesCount;
+        return dynamicShortestPaths.getDistances().back();
+    });
+
+    std::cout << "DynamicShortestPaths: " << (static_cast<double>(recomputedCount) / std::max(1LL, updatesDone)) << " nodes recomputed per update, out of " << nodeCount << std::endl;
+}
+
+
 int main() {
     test(5, {{0,1},{0,2},{1,2},{2,3},{1,3},{1,4},{3,4}}, {3,1,7,2,5,1,7}, 2, {1,4,0,2,5});
     test(5, {{0,1},{0,2},{1,2},{2,3},{1,3},{1,4},{3,4}}, {3,1,7,2,5,1,7}, 0, {0,3,1,3,4});
@@ -170,5 +463,18 @@ int main() {
     test(6, {{0,1},{1,2},{0,2},{0,5},{2,5},{4,5},{3,4},{2,3},{1,3}}, {7,10,9,14,2,9,6,11,15}, 4, {20,21,11,6,0,9});
     test(6, {{0,1},{1,2},{0,2},{0,5},{2,5},{4,5},{3,4},{2,3},{1,3}}, {7,10,9,14,2,9,6,11,15}, 5, {11,12,2,13,9,0});
 
+    testDynamicShortestPaths(10, 3, 200);
+    testDynamicShortestPaths(300, 4, 1000);
+    testDynamicShortestPaths(2000, 8, 300);
+
+    auto runner = benchmark::Runner();
+    for (const int averageDegree: {4, 32}) {
+        benchmarkDijkstra(runner, averageDegree);
+    }
+    benchmarkDynamicShortestPaths(runner);
+    runner.writeFromEnvironment();
+
+    PERF_COUNTERS_REPORT(std::cout);
+
     return 0;
 }
@@ -5,6 +5,9 @@
 
 #include <iostream>
 #include <vector>
+#include <algorithm>
+
+#include "helpers/Benchmark.hpp"
 
 
 // /**
@@ -116,6 +119,33 @@ int search2(const std::vector<int>& array, const int& target) {
 }
 
 
+/// `search2` vs. `std::equal_range`, for random targets. About `duplicatesCount` copies of each value.
+void benchmarkSearch(benchmark::Runner& runner, const int duplicatesCount) {
+    const auto elementsCount = benchmark::scaled(1000000);
+    const auto queriesCount = benchmark::scaled(100000);
+    const int maxValue = static_cast<int>(elementsCount / duplicatesCount);
+    const auto array = benchmark::generateSortedIntegers(elementsCount, 0, maxValue);
+    const auto targets = benchmark::generateRandomIntegers(queriesCount, 0, maxValue, 43);
+
+    const auto group = "occurrences (" + std::to_string(duplicatesCount) + " duplicates)";
+    runner.run(group, "search2", queriesCount, [&]() {
+        long long checksum = 0;
+        for (const auto target: targets) {
+            checksum += search2(array, target);
+        }
+        return checksum;
+    });
+    runner.run(group, "std::equal_range", queriesCount, [&]() {
+        long long checksum = 0;
+        for (const auto target: targets) {
+            const auto range = std::equal_range(array.begin(), array.end(), target);
+            checksum += range.second - range.first;
+        }
+        return checksum;
+    });
+}
+
+
 int main() {
     auto testArray1 = std::vector<int>({4, 4, 8, 8, 8, 15, 16, 23, 23, 42});
     int targetNumber1 = 8;
@@ -137,5 +167,11 @@ int main() {
     int result4 = search2(testArray4, targetNumber4);
     std::cout << result4 << std::endl;
 
+    auto runner = benchmark::Runner();
+    for (const int duplicatesCount: {1, 100}) {
+        benchmarkSearch(runner, duplicatesCount);
+    }
+    runner.writeFromEnvironment();
+
     return 0;
 }
@@ -0,0 +1,44 @@
+//
+//  Barrier.hpp
+//
+//  Reusable barrier for a fixed number of threads (`std::barrier` is C++20).
+//
+
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+
+
+class Barrier {
+private:
+    std::mutex mutex;
+    std::condition_variable conditionVariable;
+
+    const size_t threadsCount;
+    size_t waitingCount = 0;
+    /// Incremented each time all threads arrive. Protects against spurious wake-ups.
+    size_t generation = 0;
+
+public:
+    explicit Barrier(size_t threadsCount): threadsCount(threadsCount) {}
+
+public:
+    void wait() {
+        auto lock = std::unique_lock<std::mutex>(mutex);
+        const auto currentGeneration = generation;
+
+        waitingCount += 1;
+        if (waitingCount == threadsCount) {
+            // Last thread to arrive releases everyone.
+            waitingCount = 0;
+            generation += 1;
+            conditionVariable.notify_all();
+        } else {
+            conditionVariable.wait(lock, [this, currentGeneration]() {
+                return generation != currentGeneration;
+            });
+        }
+    }
+};
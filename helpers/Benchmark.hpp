@@ -0,0 +1,314 @@
+//
+//  Benchmark.hpp
+//
+//  Shared benchmark harness: warmups, repetitions, median / p99, cycles per element, CSV / JSON output.
+//
+//  - Cycles come from `rdtsc` on x86 (reference cycles at the TSC frequency), nanoseconds elsewhere.
+//  - `BENCHMARK_SCALE` (default 1) multiplies input sizes passed through `scaled`: keep defaults small, ask for realistic sizes from the environment.
+//  - `BENCHMARK_CSV` / `BENCHMARK_JSON`: paths `Runner::writeFromEnvironment` writes all results to, to compare variants or commits.
+//  - `Runner::addMetrics` attaches named values measured outside the timing (e.g. collision counts): 1 extra CSV column / JSON field each.
+//
+
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>    // __rdtsc
+#endif
+
+
+namespace benchmark {
+
+inline uint64_t readCycleCounter() {
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+#endif
+}
+
+/// Keeps the compiler from optimizing away the computation of `value`.
+template <typename T>
+inline void doNotOptimize(const T& value) {
+#if defined(__GNUC__) || defined(__clang__)
+    asm volatile("" : : "r,m"(value) : "memory");
+#else
+    static volatile const T* sink;
+    sink = &value;
+#endif
+}
+
+/// Calls `function()`, keeping its result if it has one.
+template <typename Function>
+inline void callAndKeep(Function& function) {
+    if constexpr (std::is_void_v<decltype(function())>) {
+        function();
+    } else {
+        doNotOptimize(function());
+    }
+}
+
+/// `BENCHMARK_SCALE`, 1 if unset.
+inline double getScale() {
+    const char* scale = std::getenv("BENCHMARK_SCALE");
+    return scale? std::max(std::atof(scale), 0.0): 1.0;
+}
+
+/// `count` times `BENCHMARK_SCALE`, at least 1.
+inline long long scaled(const long long count) {
+    return std::max(1LL, static_cast<long long>(std::llround(count * getScale())));
+}
+
+
+struct Options {
+    int warmupsCount = 2;
+    int repetitionsCount = 11;
+    /// Stops repeating once exceeded, after at least 3 repetitions.
+    double maxSeconds = 10;
+};
+
+
+struct Result {
+    /// What is measured, e.g. "dijkstra". Variants of 1 group are compared with each other.
+    std::string group;
+    std::string variant;
+    long long elementsCount = 0;
+    std::vector<double> nanoseconds;
+    std::vector<double> cycles;
+    /// Named values from `Runner::addMetrics`, in insertion order.
+    std::vector<std::pair<std::string, double>> metrics;
+
+    /// Nearest rank: 0.5 for the median, 0.99 for p99.
+    static double getPercentile(std::vector<double> values, const double percentile) {
+        if (values.empty()) {
+            return 0;
+        }
+        std::sort(values.begin(), values.end());
+        const auto rank = static_cast<size_t>(std::ceil(percentile * values.size()));
+        return values[std::min(values.size(), std::max<size_t>(rank, 1)) - 1];
+    }
+
+    double getMedianNanoseconds() const {
+        return getPercentile(nanoseconds, 0.5);
+    }
+
+    double getP99Nanoseconds() const {
+        return getPercentile(nanoseconds, 0.99);
+    }
+
+    double getMinNanoseconds() const {
+        return nanoseconds.empty()? 0: *std::min_element(nanoseconds.begin(), nanoseconds.end());
+    }
+
+    double getMedianCyclesPerElement() const {
+        return getPercentile(cycles, 0.5) / std::max(1LL, elementsCount);
+    }
+};
+
+
+class Runner {
+private:
+    Options options;
+    std::vector<Result> results;
+
+public:
+    explicit Runner(const Options& options = Options()): options(options) {
+    }
+
+public:
+    /**
+     * Times `function()` after `options.warmupsCount` untimed calls. `setup()` runs, untimed, before every call.
+     *
+     * @param elementsCount For cycles per element.
+     * @return A copy: later runs may reallocate the stored results.
+     */
+    template <typename Setup, typename Function>
+    Result run(const std::string& group, const std::string& variant, const long long elementsCount, Setup&& setup, Function&& function) {
+        auto result = Result();
+        result.group = group;
+        result.variant = variant;
+        result.elementsCount = elementsCount;
+
+        for (int i = 0; i < options.warmupsCount; i += 1) {
+            setup();
+            callAndKeep(function);
+        }
+
+        const auto startTime = std::chrono::steady_clock::now();
+        for (int i = 0; i < options.repetitionsCount; i += 1) {
+            setup();
+
+            const auto repetitionStartTime = std::chrono::steady_clock::now();
+            const uint64_t startCycles = readCycleCounter();
+            callAndKeep(function);
+            const uint64_t endCycles = readCycleCounter();
+            const auto repetitionEndTime = std::chrono::steady_clock::now();
+
+            result.nanoseconds.push_back(std::chrono::duration<double, std::nano>(repetitionEndTime - repetitionStartTime).count());
+            result.cycles.push_back(static_cast<double>(endCycles - startCycles));
+
+            if ((i >= 2) && (std::chrono::duration<double>(repetitionEndTime - startTime).count() > options.maxSeconds)) {
+                break;
+            }
+        }
+
+        print(result, std::cout);
+        results.push_back(result);
+        return result;
+    }
+
+    /// Without setup.
+    template <typename Function>
+    Result run(const std::string& group, const std::string& variant, const long long elementsCount, Function&& function) {
+        return run(group, variant, elementsCount, []() {}, std::forward<Function>(function));
+    }
+
+    /// Attaches `metrics` to the last result, and prints them under its line.
+    void addMetrics(const std::vector<std::pair<std::string, double>>& metrics) {
+        if (results.empty()) {
+            return;
+        }
+        auto& result = results.back();
+        for (size_t i = 0; i < metrics.size(); i += 1) {
+            result.metrics.push_back(metrics[i]);
+            std::cout << ((i == 0)? "    ": ", ") << metrics[i].first << " " << metrics[i].second;
+        }
+        std::cout << std::endl;
+    }
+
+    const std::vector<Result>& getResults() const {
+        return results;
+    }
+
+    static void print(const Result& result, std::ostream& os) {
+        os << "[Benchmark] " << result.group << " / " << result.variant << ", " << result.elementsCount << " elements: median " << (result.getMedianNanoseconds() / 1e6) << " ms, p99 " << (result.getP99Nanoseconds() / 1e6) << " ms, " << result.getMedianCyclesPerElement() << " cycles/element (" << result.nanoseconds.size() << " runs)" << std::endl;
+    }
+
+    /// 1 column per metric name of any result, empty where a result doesn't have it.
+    void writeCSV(std::ostream& os) const {
+        const auto metricNames = getMetricNames();
+        os << "group,variant,elements,runs,median_ns,p99_ns,min_ns,cycles_per_element";
+        for (const auto& name: metricNames) {
+            os << "," << quoteCSV(name);
+        }
+        os << std::endl;
+
+        for (const auto& result: results) {
+            os << quoteCSV(result.group) << "," << quoteCSV(result.variant) << "," << result.elementsCount << "," << result.nanoseconds.size() << "," << result.getMedianNanoseconds() << "," << result.getP99Nanoseconds() << "," << result.getMinNanoseconds() << "," << result.getMedianCyclesPerElement();
+            for (const auto& name: metricNames) {
+                os << ",";
+                const auto it = std::find_if(result.metrics.begin(), result.metrics.end(), [&name](const auto& metric) {
+                    return metric.first == name;
+                });
+                if (it != result.metrics.end()) {
+                    os << it->second;
+                }
+            }
+            os << std::endl;
+        }
+    }
+
+    void writeJSON(std::ostream& os) const {
+        os << "[" << std::endl;
+        for (size_t i = 0; i < results.size(); i += 1) {
+            const auto& result = results[i];
+            os << "  {\"group\": " << quoteJSON(result.group) << ", \"variant\": " << quoteJSON(result.variant) << ", \"elements\": " << result.elementsCount << ", \"runs\": " << result.nanoseconds.size() << ", \"median_ns\": " << result.getMedianNanoseconds() << ", \"p99_ns\": " << result.getP99Nanoseconds() << ", \"min_ns\": " << result.getMinNanoseconds() << ", \"cycles_per_element\": " << result.getMedianCyclesPerElement();
+            for (const auto& metric: result.metrics) {
+                os << ", " << quoteJSON(metric.first) << ": " << metric.second;
+            }
+            os << "}" << ((i + 1 < results.size())? ",": "") << std::endl;
+        }
+        os << "]" << std::endl;
+    }
+
+    /// To the paths in `BENCHMARK_CSV` and `BENCHMARK_JSON`, if set.
+    void writeFromEnvironment() const {
+        if (const char* path = std::getenv("BENCHMARK_CSV")) {
+            auto file = std::ofstream(path);
+            writeCSV(file);
+        }
+        if (const char* path = std::getenv("BENCHMARK_JSON")) {
+            auto file = std::ofstream(path);
+            writeJSON(file);
+        }
+    }
+
+private:
+    /// In order of first appearance.
+    std::vector<std::string> getMetricNames() const {
+        auto returnValue = std::vector<std::string>();
+        for (const auto& result: results) {
+            for (const auto& metric: result.metrics) {
+                if (std::find(returnValue.begin(), returnValue.end(), metric.first) == returnValue.end()) {
+                    returnValue.push_back(metric.first);
+                }
+            }
+        }
+        return returnValue;
+    }
+
+    /// RFC 4180: quotes are doubled.
+    static std::string quoteCSV(const std::string& s) {
+        auto returnValue = std::string("\"");
+        for (const char c: s) {
+            if (c == '"') {
+                returnValue += '"';
+            }
+            returnValue += c;
+        }
+        returnValue += '"';
+        return returnValue;
+    }
+
+    static std::string quoteJSON(const std::string& s) {
+        static const char HEX_DIGITS[] = "0123456789abcdef";
+
+        auto returnValue = std::string("\"");
+        for (const char c: s) {
+            if ((c == '"') || (c == '\\')) {
+                returnValue += '\\';
+                returnValue += c;
+            } else if (static_cast<unsigned char>(c) < 0x20) {
+                returnValue += "\\u00";
+                returnValue += HEX_DIGITS[c >> 4];
+                returnValue += HEX_DIGITS[c & 0xf];
+            } else {
+                returnValue += c;
+            }
+        }
+        returnValue += '"';
+        return returnValue;
+    }
+};
+
+
+#pragma mark - Input generators
+inline std::vector<int> generateRandomIntegers(const size_t count, const int min, const int max, const unsigned int seed = 42) {
+    auto generator = std::mt19937(seed);
+    auto distribution = std::uniform_int_distribution<int>(min, max);
+    auto returnValue = std::vector<int>(count);
+    for (auto& value: returnValue) {
+        value = distribution(generator);
+    }
+    return returnValue;
+}
+
+inline std::vector<int> generateSortedIntegers(const size_t count, const int min, const int max, const unsigned int seed = 42) {
+    auto returnValue = generateRandomIntegers(count, min, max, seed);
+    std::sort(returnValue.begin(), returnValue.end());
+    return returnValue;
+}
+
+}
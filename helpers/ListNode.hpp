@@ -0,0 +1,42 @@
+//
+//  ListNode.hpp
+//
+//  Singly linked list node, and conversions from / to vectors for tests.
+//
+
+#pragma once
+
+#include <vector>
+
+
+struct ListNode {
+    int val;
+    ListNode* next;
+
+    ListNode(): val(0), next(nullptr) {}
+    explicit ListNode(int x): val(x), next(nullptr) {}
+    ListNode(int x, ListNode* next): val(x), next(next) {}
+};
+
+
+namespace ListHelper {
+
+/// Values from `head` to the end.
+inline std::vector<int> serialize(const ListNode* head) {
+    auto returnValue = std::vector<int>();
+    for (auto node = head; node; node = node->next) {
+        returnValue.push_back(node->val);
+    }
+    return returnValue;
+}
+
+/// Allocates 1 node per value with `new`: the caller owns them. nullptr if empty.
+inline ListNode* deserialize(const std::vector<int>& values) {
+    ListNode* head = nullptr;
+    for (auto it = values.rbegin(); it != values.rend(); ++it) {
+        head = new ListNode(*it, head);
+    }
+    return head;
+}
+
+}
@@ -0,0 +1,33 @@
+//
+//  Operators.hpp
+//
+//  Stream operators for printing containers in tests.
+//
+
+#pragma once
+
+#include <iostream>
+#include <utility>
+#include <vector>
+
+
+/// `{1,2,3}`, `{}` when empty.
+template <typename T>
+std::ostream& operator << (std::ostream& os, const std::vector<T>& v) {
+    os << "{";
+    for (auto it = v.begin(); it != v.end(); ++it) {
+        if (it != v.begin()) {
+            os << ",";
+        }
+        os << *it;
+    }
+    os << "}";
+    return os;
+}
+
+/// `(first,second)`.
+template <typename T1, typename T2>
+std::ostream& operator << (std::ostream& os, const std::pair<T1, T2>& p) {
+    os << "(" << p.first << "," << p.second << ")";
+    return os;
+}
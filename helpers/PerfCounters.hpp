@@ -0,0 +1,267 @@
+//
+//  PerfCounters.hpp
+//
+//  Scoped hardware performance counters (Linux `perf_event_open`), aggregated per region.
+//
+//  Usage:
+//      PERF_COUNTERS_SCOPE("dijkstraHeap loop");    // Counts until the end of the enclosing scope.
+//      PERF_COUNTERS_REPORT(std::cout);             // Totals per region.
+//
+//  Both macros expand to nothing unless compiled with `-DPERF_COUNTERS=1`: no overhead when off.
+//  When on, a scope costs a few `read` system calls (about 1 µs): place it around loops, not inside them.
+//  Counters the kernel refuses (no PMU in a VM, `perf_event_paranoid`) are reported as n/a; calls and wall time are always counted.
+//  The events are opened as 1 group, so they always count over the same time window (IPC stays meaningful).
+//  If the PMU multiplexes the group with other users, counts are scaled by enabled / running time, and the report shows the fraction counted.
+//
+
+#pragma once
+
+#if defined(PERF_COUNTERS) && PERF_COUNTERS
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+
+namespace perf_counters {
+
+enum Event {
+    cycles,
+    instructions,
+    llcMisses,
+    branchMisses,
+    eventsCount,
+};
+
+inline const char* getEventName(const int event) {
+    static const char* names[] = {"cycles", "instructions", "LLC misses", "branch misses"};
+    return names[event];
+}
+
+
+/// Counter values at 1 point in time. `enabledNanoseconds` and `runningNanoseconds` differ when the PMU multiplexes the group.
+struct Sample {
+    std::array<uint64_t, eventsCount> values{};
+    uint64_t enabledNanoseconds = 0;
+    uint64_t runningNanoseconds = 0;
+};
+
+
+/// 1 group of events (the first one that opens leads), opened once per thread. Counts this thread only, user space only.
+class ThreadCounters {
+private:
+    std::array<int, eventsCount> fileDescriptors;
+    int leaderFileDescriptor = -1;
+    /// Events in the order the group read returns them.
+    std::vector<int> groupEvents;
+
+public:
+    ThreadCounters() {
+        fileDescriptors.fill(-1);
+#if defined(__linux__)
+        static const uint64_t configs[] = {PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS, PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_HW_BRANCH_MISSES};
+        for (int event = 0; event < eventsCount; event += 1) {
+            auto attributes = perf_event_attr();
+            attributes.size = sizeof(attributes);
+            attributes.type = PERF_TYPE_HARDWARE;
+            attributes.config = configs[event];
+            attributes.exclude_kernel = 1;
+            attributes.exclude_hv = 1;
+            attributes.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+            fileDescriptors[event] = static_cast<int>(syscall(SYS_perf_event_open, &attributes, 0, -1, leaderFileDescriptor, 0));
+            if (fileDescriptors[event] >= 0) {
+                if (leaderFileDescriptor < 0) {
+                    leaderFileDescriptor = fileDescriptors[event];
+                }
+                groupEvents.push_back(event);
+            }
+        }
+#endif
+    }
+
+    ThreadCounters(const ThreadCounters&) = delete;
+    ThreadCounters& operator = (const ThreadCounters&) = delete;
+
+    ~ThreadCounters() {
+#if defined(__linux__)
+        // Members before the leader.
+        for (auto it = groupEvents.rbegin(); it != groupEvents.rend(); ++it) {
+            close(fileDescriptors[*it]);
+        }
+#endif
+    }
+
+public:
+    bool isAvailable(const int event) const {
+        return fileDescriptors[event] >= 0;
+    }
+
+    /// Current values of the whole group in 1 read, 0 for unavailable events.
+    Sample read() const {
+        auto returnValue = Sample();
+#if defined(__linux__)
+        if (leaderFileDescriptor < 0) {
+            return returnValue;
+        }
+
+        // {nr, time_enabled, time_running, value[nr]}
+        auto buffer = std::array<uint64_t, 3 + eventsCount>{};
+        const auto expectedSize = static_cast<ssize_t>(sizeof(uint64_t) * (3 + groupEvents.size()));
+        if ((::read(leaderFileDescriptor, buffer.data(), sizeof(buffer)) != expectedSize) || (buffer[0] != groupEvents.size())) {
+            return returnValue;
+        }
+        returnValue.enabledNanoseconds = buffer[1];
+        returnValue.runningNanoseconds = buffer[2];
+        for (size_t i = 0; i < groupEvents.size(); i += 1) {
+            returnValue.values[groupEvents[i]] = buffer[3 + i];
+        }
+#endif
+        return returnValue;
+    }
+
+    static ThreadCounters& getInstance() {
+        thread_local auto instance = ThreadCounters();
+        return instance;
+    }
+};
+
+
+/// Totals of 1 region, over every thread and call.
+struct Region {
+    std::string name;
+    std::atomic<uint64_t> callsCount{0};
+    std::atomic<uint64_t> nanoseconds{0};
+    /// Scaled to the whole enabled time.
+    std::array<std::atomic<uint64_t>, eventsCount> totals{};
+    std::atomic<uint64_t> enabledNanoseconds{0};
+    std::atomic<uint64_t> runningNanoseconds{0};
+    /// Whether every call could read the event.
+    std::array<std::atomic<bool>, eventsCount> isAvailable{};
+
+    explicit Region(const std::string& name): name(name) {
+        for (auto& available: isAvailable) {
+            available = true;
+        }
+    }
+};
+
+
+class Registry {
+private:
+    std::mutex mutex;
+    std::vector<std::unique_ptr<Region>> regions;
+
+public:
+    /// Called once per region (from a function-local static): the lock is off the hot path.
+    Region& getRegion(const std::string& name) {
+        auto lock = std::lock_guard<std::mutex>(mutex);
+        for (auto& region: regions) {
+            if (region->name == name) {
+                return *region;
+            }
+        }
+        regions.push_back(std::make_unique<Region>(name));
+        return *regions.back();
+    }
+
+    void report(std::ostream& os) {
+        auto lock = std::lock_guard<std::mutex>(mutex);
+        for (const auto& region: regions) {
+            const uint64_t callsCount = region->callsCount;
+            os << "[Perf] " << region->name << ": " << callsCount << " calls, " << (region->nanoseconds / 1e6) << " ms";
+            for (int event = 0; event < eventsCount; event += 1) {
+                os << ", " << getEventName(event) << " ";
+                if (region->isAvailable[event]) {
+                    os << region->totals[event];
+                } else {
+                    os << "n/a";
+                }
+            }
+            if (region->isAvailable[cycles] && region->isAvailable[instructions] && (region->totals[cycles] > 0)) {
+                os << ", IPC " << (static_cast<double>(region->totals[instructions]) / region->totals[cycles]);
+            }
+            if (region->runningNanoseconds < region->enabledNanoseconds) {
+                os << " (multiplexed: counted " << (100.0 * region->runningNanoseconds / region->enabledNanoseconds) << "% of the time, scaled)";
+            }
+            os << std::endl;
+        }
+    }
+
+    static Registry& getInstance() {
+        static auto instance = Registry();
+        return instance;
+    }
+};
+
+
+/// Adds the counts between its construction and destruction to `region`.
+class Scope {
+private:
+    Region& region;
+    ThreadCounters& counters;
+    Sample startSample;
+    std::chrono::steady_clock::time_point startTime;
+
+public:
+    explicit Scope(Region& region): region(region), counters(ThreadCounters::getInstance()) {
+        startTime = std::chrono::steady_clock::now();
+        startSample = counters.read();
+    }
+
+    Scope(const Scope&) = delete;
+    Scope& operator = (const Scope&) = delete;
+
+    ~Scope() {
+        const auto endSample = counters.read();
+        const auto endTime = std::chrono::steady_clock::now();
+
+        region.callsCount.fetch_add(1, std::memory_order_relaxed);
+        region.nanoseconds.fetch_add(std::chrono::duration_cast<std::chrono::nanoseconds>(endTime - startTime).count(), std::memory_order_relaxed);
+
+        // The group counted for `running` out of `enabled` nanoseconds of this scope: extrapolate.
+        const uint64_t enabled = endSample.enabledNanoseconds - startSample.enabledNanoseconds;
+        const uint64_t running = endSample.runningNanoseconds - startSample.runningNanoseconds;
+        const double scale = (running > 0)? (static_cast<double>(enabled) / running): 0;
+        region.enabledNanoseconds.fetch_add(enabled, std::memory_order_relaxed);
+        region.runningNanoseconds.fetch_add(running, std::memory_order_relaxed);
+
+        for (int event = 0; event < eventsCount; event += 1) {
+            if (counters.isAvailable(event)) {
+                const uint64_t count = endSample.values[event] - startSample.values[event];
+                region.totals[event].fetch_add(static_cast<uint64_t>(count * scale + 0.5), std::memory_order_relaxed);
+            } else {
+                region.isAvailable[event].store(false, std::memory_order_relaxed);
+            }
+        }
+    }
+};
+
+}
+
+
+#define PERF_COUNTERS_CONCATENATE_(a, b) a##b
+#define PERF_COUNTERS_CONCATENATE(a, b) PERF_COUNTERS_CONCATENATE_(a, b)
+#define PERF_COUNTERS_SCOPE(name) \
+    static auto& PERF_COUNTERS_CONCATENATE(perfCountersRegion, __LINE__) = perf_counters::Registry::getInstance().getRegion(name); \
+    const perf_counters::Scope PERF_COUNTERS_CONCATENATE(perfCountersScope, __LINE__)(PERF_COUNTERS_CONCATENATE(perfCountersRegion, __LINE__))
+#define PERF_COUNTERS_REPORT(os) perf_counters::Registry::getInstance().report(os)
+
+#else
+
+#define PERF_COUNTERS_SCOPE(name)
+#define PERF_COUNTERS_REPORT(os)
+
+#endif
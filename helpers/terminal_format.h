@@ -0,0 +1,17 @@
+//
+//  terminal_format.h
+//
+//  ANSI escape sequences for coloring test output.
+//
+
+#pragma once
+
+
+namespace terminal_format {
+
+const char* const OK_GREEN = "\033[92m";
+const char* const FAIL = "\033[91m";
+const char* const BOLD = "\033[1m";
+const char* const ENDC = "\033[0m";
+
+}
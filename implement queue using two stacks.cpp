@@ -1,8 +1,27 @@
 #include <iostream>
 #include <stack>
 #include <memory>
+#include <vector>
+#include <queue>
+#include <deque>
+#include <iterator>
+#include <stdexcept>
+#include <random>
+#include <atomic>
+#include <thread>
+#include <algorithm>
+#include <mutex>
+#include <condition_variable>
+#include <cstdint>
 
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>    // _mm_pause
+#endif
 
+#include "helpers/Benchmark.hpp"
+
+
+#pragma mark - 1. Move everything on every enqueue
 class FakeQueue {
 private:
     /// Temporary stack.
@@ -41,6 +60,1041 @@ public:
     }
 };
 
+#pragma mark - 2. Lazy transfer
+/*
+ * Push to `inbox`, pop from `outbox`.
+ * `outbox` is only refilled (by reversing `inbox` into it) when it's empty, so each element is moved at most twice: amortized O(1) per operation.
+ *
+ * Both stacks are `std::vector`s: contiguous, and their capacity is reused.
+ */
+template <typename T>
+class TwoStackQueue {
+private:
+    /// Newest element on top.
+    std::vector<T> inbox;
+    /// Oldest element on top.
+    std::vector<T> outbox;
+
+public:
+    [[nodiscard]] bool empty() const {
+        return inbox.empty() && outbox.empty();
+    }
+
+    [[nodiscard]] size_t size() const {
+        return inbox.size() + outbox.size();
+    }
+
+public:
+    void enqueue(T element) {
+        inbox.push_back(std::move(element));
+    }
+
+    template <typename InputIterator>
+    void enqueueRange(InputIterator first, InputIterator last) {
+        inbox.insert(inbox.end(), first, last);
+    }
+
+    T dequeue() {
+        if (outbox.empty()) {
+            refillOutbox();
+            if (outbox.empty()) {
+                throw std::runtime_error("The queue is empty.");
+            }
+        }
+
+        T returnValue = std::move(outbox.back());
+        outbox.pop_back();
+        return returnValue;
+    }
+
+    /**
+     * Dequeues up to `count` elements, oldest first.
+     *
+     * @return The number of elements written to `output` (fewer than `count` if the queue runs out).
+     */
+    template <typename OutputIterator>
+    size_t dequeueN(size_t count, OutputIterator output) {
+        size_t returnValue = 0;
+        while (count > 0) {
+            if (outbox.empty()) {
+                refillOutbox();
+                if (outbox.empty()) {
+                    break;
+                }
+            }
+
+            // The oldest elements are at the back of `outbox`.
+            const size_t batchCount = std::min(count, outbox.size());
+            output = std::move(outbox.rbegin(), outbox.rbegin() + batchCount, output);
+            outbox.resize(outbox.size() - batchCount);
+
+            count -= batchCount;
+            returnValue += batchCount;
+        }
+
+        return returnValue;
+    }
+
+private:
+    void refillOutbox() {
+        outbox.insert(outbox.end(), std::make_move_iterator(inbox.rbegin()), std::make_move_iterator(inbox.rend()));
+        inbox.clear();
+    }
+};
+
+
+#pragma mark - 3. Single-producer single-consumer ring buffer
+/*
+ * Bounded lock-free queue for exactly 1 producer thread and 1 consumer thread.
+ *
+ * - `tail` is only written by the producer, `head` only by the consumer. Each lives on its own cache line, so they don't false-share.
+ * - Each side keeps a cached copy of the other side's index, and only reloads it (a cache miss) when the queue looks full / empty.
+ * - Indices grow forever and are masked into the buffer: capacity is a power of 2.
+ */
+static const size_t CACHE_LINE_SIZE = 64;
+
+template <typename T>
+class SPSCQueue {
+private:
+    const size_t capacity;
+    const size_t mask;
+    std::unique_ptr<T[]> buffer;
+
+    // Producer side.
+    alignas(CACHE_LINE_SIZE) std::atomic<size_t> tail;
+    /// Producer's last known `head`.
+    size_t cachedHead;
+
+    // Consumer side.
+    alignas(CACHE_LINE_SIZE) std::atomic<size_t> head;
+    /// Consumer's last known `tail`.
+    size_t cachedTail;
+
+public:
+    /// @param capacity Rounded up to a power of 2.
+    explicit SPSCQueue(const size_t capacity): capacity(roundUpToPowerOf2(capacity)), mask(this->capacity - 1), buffer(new T[this->capacity]), tail(0), cachedHead(0), head(0), cachedTail(0) {}
+
+    SPSCQueue(const SPSCQueue&) = delete;
+    SPSCQueue& operator = (const SPSCQueue&) = delete;
+
+public:
+    #pragma mark Producer
+    bool tryEnqueue(T element) {
+        const size_t currentTail = tail.load(std::memory_order_relaxed);
+        if ((currentTail - cachedHead) == capacity) {
+            cachedHead = head.load(std::memory_order_acquire);
+            if ((currentTail - cachedHead) == capacity) {
+                // Full.
+                return false;
+            }
+        }
+
+        buffer[currentTail & mask] = std::move(element);
+        tail.store(currentTail + 1, std::memory_order_release);
+        return true;
+    }
+
+    /// Spins while the queue is full.
+    void enqueue(T element) {
+        while (!tryEnqueue(element)) {
+            std::this_thread::yield();
+        }
+    }
+
+    /**
+     * Enqueues as many of `elements[0, count)` as fit, with a single `tail` update.
+     *
+     * @return The number of elements enqueued.
+     */
+    size_t tryEnqueueN(const T* elements, const size_t count) {
+        const size_t currentTail = tail.load(std::memory_order_relaxed);
+        if ((capacity - (currentTail - cachedHead)) < count) {
+            cachedHead = head.load(std::memory_order_acquire);
+        }
+
+        const size_t batchCount = std::min(count, capacity - (currentTail - cachedHead));
+        for (size_t i = 0; i < batchCount; i += 1) {
+            buffer[(currentTail + i) & mask] = elements[i];
+        }
+        tail.store(currentTail + batchCount, std::memory_order_release);
+        return batchCount;
+    }
+
+    #pragma mark Consumer
+    bool tryDequeue(T& element) {
+        const size_t currentHead = head.load(std::memory_order_relaxed);
+        if (currentHead == cachedTail) {
+            cachedTail = tail.load(std::memory_order_acquire);
+            if (currentHead == cachedTail) {
+                // Empty.
+                return false;
+            }
+        }
+
+        element = std::move(buffer[currentHead & mask]);
+        head.store(currentHead + 1, std::memory_order_release);
+        return true;
+    }
+
+    /// Spins while the queue is empty.
+    T dequeue() {
+        T returnValue;
+        while (!tryDequeue(returnValue)) {
+            std::this_thread::yield();
+        }
+        return returnValue;
+    }
+
+    /**
+     * Dequeues up to `count` elements into `elements`, with a single `head` update.
+     *
+     * @return The number of elements dequeued.
+     */
+    size_t tryDequeueN(T* elements, const size_t count) {
+        const size_t currentHead = head.load(std::memory_order_relaxed);
+        if ((cachedTail - currentHead) < count) {
+            cachedTail = tail.load(std::memory_order_acquire);
+        }
+
+        const size_t batchCount = std::min(count, cachedTail - currentHead);
+        for (size_t i = 0; i < batchCount; i += 1) {
+            elements[i] = std::move(buffer[(currentHead + i) & mask]);
+        }
+        head.store(currentHead + batchCount, std::memory_order_release);
+        return batchCount;
+    }
+
+private:
+    static size_t roundUpToPowerOf2(const size_t x) {
+        size_t returnValue = 1;
+        while (returnValue < x) {
+            returnValue *= 2;
+        }
+        return returnValue;
+    }
+};
+
+
+#pragma mark - 4. Multi-producer multi-consumer ring buffer
+/*
+ * Bounded lock-free queue for any number of producers and consumers (Dmitry Vyukov's design).
+ *
+ * https://www.1024cores.net/home/lock-free-algorithms/queues/bounded-mpmc-queue
+ *
+ * - Each cell has a sequence number telling whose turn it is: `position` (free for the producer of `position`) or `position + 1` (ready for the consumer of `position`).
+ * - Producers claim a position by CAS on `enqueuePosition`, consumers on `dequeuePosition`. Cells are only contended by threads of the same lap.
+ * - Failed CAS and full / empty queues back off exponentially: pause instructions, then `yield`.
+ *
+ * With `WaitMode::block`, threads that keep failing sleep on a condition variable instead of spinning, so idle consumers don't burn CPU.
+ * The fast path only pays an extra load of the sleepers count.
+ */
+enum class WaitMode {
+    spin,
+    block,
+};
+
+
+class Backoff {
+private:
+    static const int MAX_PAUSES_COUNT = 64;
+
+    int pausesCount = 1;
+
+public:
+    void pause() {
+        if (pausesCount <= MAX_PAUSES_COUNT) {
+            for (int i = 0; i < pausesCount; i += 1) {
+#if defined(__x86_64__) || defined(__i386__)
+                _mm_pause();
+#endif
+            }
+            pausesCount *= 2;
+        } else {
+            std::this_thread::yield();
+        }
+    }
+
+    /// Has it given up spinning?
+    [[nodiscard]] bool isYielding() const {
+        return pausesCount > MAX_PAUSES_COUNT;
+    }
+};
+
+
+template <typename T>
+class MPMCQueue {
+private:
+    struct alignas(CACHE_LINE_SIZE) Cell {
+        std::atomic<size_t> sequence;
+        T data;
+    };
+
+    /// Threads blocked on one side, with what they wait on.
+    struct Sleepers {
+        std::atomic<size_t> count{0};
+        std::mutex mutex;
+        std::condition_variable conditionVariable;
+    };
+
+private:
+    const size_t capacity;
+    const size_t mask;
+    std::unique_ptr<Cell[]> cells;
+    const WaitMode waitMode;
+
+    alignas(CACHE_LINE_SIZE) std::atomic<size_t> enqueuePosition;
+    alignas(CACHE_LINE_SIZE) std::atomic<size_t> dequeuePosition;
+
+    alignas(CACHE_LINE_SIZE) Sleepers sleepingProducers;
+    alignas(CACHE_LINE_SIZE) Sleepers sleepingConsumers;
+
+public:
+    /// @param capacity Rounded up to a power of 2 (at least 2).
+    explicit MPMCQueue(const size_t capacity, const WaitMode waitMode = WaitMode::spin): capacity(roundUpToPowerOf2(std::max<size_t>(capacity, 2))), mask(this->capacity - 1), cells(new Cell[this->capacity]), waitMode(waitMode), enqueuePosition(0), dequeuePosition(0) {
+        for (size_t i = 0; i < this->capacity; i += 1) {
+            cells[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    MPMCQueue(const MPMCQueue&) = delete;
+    MPMCQueue& operator = (const MPMCQueue&) = delete;
+
+public:
+    bool tryEnqueue(T element) {
+        if (!tryEnqueueWithoutWakeUp(element)) {
+            return false;
+        }
+
+        wakeUp(sleepingConsumers);
+        return true;
+    }
+
+    bool tryDequeue(T& element) {
+        if (!tryDequeueWithoutWakeUp(element)) {
+            return false;
+        }
+
+        wakeUp(sleepingProducers);
+        return true;
+    }
+
+    /// Backs off while the queue is full. Sleeps in `WaitMode::block`.
+    void enqueue(T element) {
+        auto backoff = Backoff();
+        while (!tryEnqueue(element)) {
+            if ((waitMode == WaitMode::block) && backoff.isYielding()) {
+                sleepUntil(sleepingProducers, [this, &element]() {
+                    return tryEnqueueWithoutWakeUp(element);
+                });
+                wakeUp(sleepingConsumers);
+                return;
+            }
+            backoff.pause();
+        }
+    }
+
+    /// Backs off while the queue is empty. Sleeps in `WaitMode::block`.
+    T dequeue() {
+        T returnValue;
+
+        auto backoff = Backoff();
+        while (!tryDequeue(returnValue)) {
+            if ((waitMode == WaitMode::block) && backoff.isYielding()) {
+                sleepUntil(sleepingConsumers, [this, &returnValue]() {
+                    return tryDequeueWithoutWakeUp(returnValue);
+                });
+                wakeUp(sleepingProducers);
+                break;
+            }
+            backoff.pause();
+        }
+
+        return returnValue;
+    }
+
+private:
+    /// Doesn't wake up sleeping consumers: it may run under `sleepingProducers.mutex`, and taking the other mutex there could deadlock.
+    bool tryEnqueueWithoutWakeUp(T& element) {
+        auto backoff = Backoff();
+
+        size_t position = enqueuePosition.load(std::memory_order_relaxed);
+        Cell* cell = nullptr;
+        while (true) {
+            cell = &cells[position & mask];
+            const size_t sequence = cell->sequence.load(std::memory_order_acquire);
+            const auto difference = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(position);
+
+            if (difference == 0) {
+                // The cell is free: claim `position`.
+                if (enqueuePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+                backoff.pause();
+            } else if (difference < 0) {
+                // The consumer of the previous lap hasn't freed it yet: full.
+                return false;
+            } else {
+                // Another producer took `position`.
+                position = enqueuePosition.load(std::memory_order_relaxed);
+            }
+        }
+
+        cell->data = std::move(element);
+        cell->sequence.store(position + 1, std::memory_order_release);
+        return true;
+    }
+
+    /// Doesn't wake up sleeping producers, for the same reason.
+    bool tryDequeueWithoutWakeUp(T& element) {
+        auto backoff = Backoff();
+
+        size_t position = dequeuePosition.load(std::memory_order_relaxed);
+        Cell* cell = nullptr;
+        while (true) {
+            cell = &cells[position & mask];
+            const size_t sequence = cell->sequence.load(std::memory_order_acquire);
+            const auto difference = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(position + 1);
+
+            if (difference == 0) {
+                // The cell is ready: claim `position`.
+                if (dequeuePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+                backoff.pause();
+            } else if (difference < 0) {
+                // Its producer hasn't written it yet: empty.
+                return false;
+            } else {
+                // Another consumer took `position`.
+                position = dequeuePosition.load(std::memory_order_relaxed);
+            }
+        }
+
+        element = std::move(cell->data);
+        // Free the cell for the producer of the next lap.
+        cell->sequence.store(position + mask + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * Registers as a sleeper, then waits until `tryOperation()` succeeds.
+     *
+     * The registration is visible before `tryOperation()` runs, and `wakeUp` reads it after publishing, so a wake-up can't be lost.
+     */
+    template <typename TryOperation>
+    void sleepUntil(Sleepers& sleepers, TryOperation&& tryOperation) {
+        auto lock = std::unique_lock<std::mutex>(sleepers.mutex);
+        sleepers.count.fetch_add(1);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+
+        sleepers.conditionVariable.wait(lock, tryOperation);
+
+        sleepers.count.fetch_sub(1);
+    }
+
+    void wakeUp(Sleepers& sleepers) {
+        if (waitMode != WaitMode::block) {
+            return;
+        }
+
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (sleepers.count.load(std::memory_order_relaxed) > 0) {
+            // Taking the mutex orders this after the sleeper's check.
+            auto lock = std::lock_guard<std::mutex>(sleepers.mutex);
+            sleepers.conditionVariable.notify_one();
+        }
+    }
+
+    static size_t roundUpToPowerOf2(const size_t x) {
+        size_t returnValue = 1;
+        while (returnValue < x) {
+            returnValue *= 2;
+        }
+        return returnValue;
+    }
+};
+
+
+#pragma mark - 5. Lock-free two-stack queue (many producers, one consumer)
+/*
+ * The two-stack idea of `TwoStackQueue`, made concurrent for many producers and 1 consumer (e.g. a logger).
+ *
+ * - Inbox: Treiber stack. Producers push with 1 CAS, newest on top.
+ * - Outbox: plain list owned by the consumer. When empty, the consumer takes the whole inbox with 1 `exchange` and reverses it.
+ * - Nodes are recycled through a pool, itself a Treiber stack: the consumer gives back drained nodes as 1 chain, producers pop them.
+ *
+ * Reclamation: a node taken by the `exchange` is only reachable by the consumer, so the queue itself needs no hazard pointers.
+ * The only racy read is a producer reading `top->next` in the pool while another producer pops `top`.
+ * Pool memory is never freed before the queue (type-stable), so that read is safe, and the tag in the head makes the CAS fail if `top` was popped and pushed back meanwhile (ABA).
+ */
+template <typename Node>
+class TaggedStack {
+private:
+    // x86-64 and AArch64 user space pointers fit in 48 bits: the top 16 bits hold the tag.
+    static_assert(sizeof(void*) == 8, "Tagged pointers need 64-bit pointers");
+    static const int POINTER_BITS_COUNT = 48;
+    static const uint64_t POINTER_MASK = (uint64_t(1) << POINTER_BITS_COUNT) - 1;
+
+    alignas(CACHE_LINE_SIZE) std::atomic<uint64_t> head{0};
+
+public:
+    /// Pushes the chain `first` -> ... -> `last`.
+    void pushChain(Node* first, Node* last) {
+        uint64_t oldHead = head.load(std::memory_order_relaxed);
+        do {
+            last->next.store(getPointer(oldHead), std::memory_order_relaxed);
+        } while (!head.compare_exchange_weak(oldHead, makeHead(first, getTag(oldHead) + 1), std::memory_order_release, std::memory_order_relaxed));
+    }
+
+    void push(Node* node) {
+        pushChain(node, node);
+    }
+
+    /// @return nullptr if empty.
+    Node* pop() {
+        uint64_t oldHead = head.load(std::memory_order_acquire);
+        while (true) {
+            Node* top = getPointer(oldHead);
+            if (top == nullptr) {
+                return nullptr;
+            }
+
+            // `top` may be popped by someone else right now: `next` is then stale, and the tag makes the CAS fail.
+            Node* next = top->next.load(std::memory_order_relaxed);
+            if (head.compare_exchange_weak(oldHead, makeHead(next, getTag(oldHead) + 1), std::memory_order_acquire, std::memory_order_acquire)) {
+                return top;
+            }
+        }
+    }
+
+    /// Takes every node at once with 1 `exchange`, newest first.
+    /// It resets the tag: don't mix with concurrent `pop`.
+    Node* popAll() {
+        return getPointer(head.exchange(0, std::memory_order_acquire));
+    }
+
+private:
+    static Node* getPointer(const uint64_t taggedPointer) {
+        return reinterpret_cast<Node*>(taggedPointer & POINTER_MASK);
+    }
+
+    static uint64_t getTag(const uint64_t taggedPointer) {
+        return taggedPointer >> POINTER_BITS_COUNT;
+    }
+
+    static uint64_t makeHead(Node* pointer, const uint64_t tag) {
+        return (tag << POINTER_BITS_COUNT) | reinterpret_cast<uint64_t>(pointer);
+    }
+};
+
+
+template <typename T>
+class TwoStackMPSCQueue {
+private:
+    struct Node {
+        std::atomic<Node*> next{nullptr};
+        T value;
+    };
+
+    /// Nodes are allocated by blocks and only freed with the queue.
+    static const size_t BLOCK_SIZE = 256;
+    struct Block {
+        Block* next = nullptr;
+        Node nodes[BLOCK_SIZE];
+    };
+
+private:
+    TaggedStack<Node> inbox;
+    TaggedStack<Node> pool;
+    alignas(CACHE_LINE_SIZE) std::atomic<Block*> blocks{nullptr};
+
+    /// Consumer only. Oldest first.
+    alignas(CACHE_LINE_SIZE) Node* outbox = nullptr;
+    /// Consumer only. Dequeued nodes, given back to `pool` as 1 chain when `outbox` runs out.
+    Node* freedFirst = nullptr;
+    Node* freedLast = nullptr;
+
+public:
+    TwoStackMPSCQueue() = default;
+
+    TwoStackMPSCQueue(const TwoStackMPSCQueue&) = delete;
+    TwoStackMPSCQueue& operator = (const TwoStackMPSCQueue&) = delete;
+
+    ~TwoStackMPSCQueue() {
+        Block* block = blocks.load(std::memory_order_acquire);
+        while (block != nullptr) {
+            Block* next = block->next;
+            delete block;
+            block = next;
+        }
+    }
+
+public:
+    /// Any thread. Lock-free; allocates only when the pool is empty.
+    void enqueue(T element) {
+        Node* node = pool.pop();
+        if (node == nullptr) {
+            node = allocateNodes();
+        }
+        node->value = std::move(element);
+        inbox.push(node);
+    }
+
+    #pragma mark Consumer
+    /// Consumer thread only.
+    bool tryDequeue(T& element) {
+        if (outbox == nullptr) {
+            recycleFreedNodes();
+
+            // Reverse the inbox: oldest first.
+            Node* node = inbox.popAll();
+            while (node != nullptr) {
+                Node* next = node->next.load(std::memory_order_relaxed);
+                node->next.store(outbox, std::memory_order_relaxed);
+                outbox = node;
+                node = next;
+            }
+            if (outbox == nullptr) {
+                return false;
+            }
+        }
+
+        Node* node = outbox;
+        outbox = node->next.load(std::memory_order_relaxed);
+        element = std::move(node->value);
+
+        node->next.store(freedFirst, std::memory_order_relaxed);
+        freedFirst = node;
+        if (freedLast == nullptr) {
+            freedLast = node;
+        }
+        return true;
+    }
+
+    /// Consumer thread only. Backs off while the queue is empty.
+    T dequeue() {
+        T returnValue;
+        auto backoff = Backoff();
+        while (!tryDequeue(returnValue)) {
+            backoff.pause();
+        }
+        return returnValue;
+    }
+
+private:
+    void recycleFreedNodes() {
+        if (freedFirst != nullptr) {
+            pool.pushChain(freedFirst, freedLast);
+            freedFirst = nullptr;
+            freedLast = nullptr;
+        }
+    }
+
+    /// Allocates a block, keeps its first node and gives the others to the pool.
+    Node* allocateNodes() {
+        auto block = new Block();
+        block->next = blocks.load(std::memory_order_relaxed);
+        while (!blocks.compare_exchange_weak(block->next, block, std::memory_order_release, std::memory_order_relaxed)) {
+        }
+
+        for (size_t i = 1; i + 1 < BLOCK_SIZE; i += 1) {
+            block->nodes[i].next.store(&block->nodes[i + 1], std::memory_order_relaxed);
+        }
+        pool.pushChain(&block->nodes[1], &block->nodes[BLOCK_SIZE - 1]);
+        return &block->nodes[0];
+    }
+};
+
+
+#pragma mark - Tests
+/// Random operations against `std::queue`.
+void testTwoStackQueue(const int operationsCount) {
+    auto generator = std::mt19937(42);
+
+    auto queue = TwoStackQueue<int>();
+    auto expectedQueue = std::queue<int>();
+
+    int nextValue = 0;
+    for (int i = 0; i < operationsCount; i += 1) {
+        const auto operation = generator() % 4;
+        if ((operation == 0) || expectedQueue.empty()) {
+            queue.enqueue(nextValue);
+            expectedQueue.push(nextValue);
+            nextValue += 1;
+        } else if (operation == 1) {
+            const auto values = std::vector<int>({nextValue, nextValue + 1, nextValue + 2});
+            queue.enqueueRange(values.begin(), values.end());
+            for (const auto& value: values) {
+                expectedQueue.push(value);
+            }
+            nextValue += 3;
+        } else if (operation == 2) {
+            if (queue.dequeue() != expectedQueue.front()) {
+                std::cout << "[Wrong] dequeue() at operation " << i << std::endl;
+                return;
+            }
+            expectedQueue.pop();
+        } else {
+            auto values = std::vector<int>();
+            const auto count = queue.dequeueN(5, std::back_inserter(values));
+            if (count != values.size()) {
+                std::cout << "[Wrong] dequeueN() count at operation " << i << std::endl;
+                return;
+            }
+            for (const auto& value: values) {
+                if (value != expectedQueue.front()) {
+                    std::cout << "[Wrong] dequeueN() at operation " << i << std::endl;
+                    return;
+                }
+                expectedQueue.pop();
+            }
+        }
+
+        if (queue.size() != expectedQueue.size()) {
+            std::cout << "[Wrong] size() at operation " << i << std::endl;
+            return;
+        }
+    }
+
+    std::cout << "[Correct] " << operationsCount << " random operations" << std::endl;
+}
+
+
+/// 1 producer thread and 1 consumer thread: every element must arrive once, in order.
+void testSPSCQueue(const size_t capacity, const size_t batchSize, const int elementsCount) {
+    auto queue = SPSCQueue<int>(capacity);
+
+    auto producer = std::thread([&queue, batchSize, elementsCount]() {
+        auto batch = std::vector<int>(batchSize);
+        int nextValue = 0;
+        while (nextValue < elementsCount) {
+            if (batchSize == 1) {
+                queue.enqueue(nextValue);
+                nextValue += 1;
+            } else {
+                const int count = std::min(static_cast<int>(batchSize), elementsCount - nextValue);
+                for (int i = 0; i < count; i += 1) {
+                    batch[i] = nextValue + i;
+                }
+                const auto enqueuedCount = static_cast<int>(queue.tryEnqueueN(batch.data(), count));
+                if (enqueuedCount == 0) {
+                    // Full: let the consumer run (a single core would otherwise spin for the whole time slice).
+                    std::this_thread::yield();
+                }
+                nextValue += enqueuedCount;
+            }
+        }
+    });
+
+    bool isInOrder = true;
+    int expectedValue = 0;
+    auto batch = std::vector<int>(batchSize);
+    while (expectedValue < elementsCount) {
+        if (batchSize == 1) {
+            isInOrder = isInOrder && (queue.dequeue() == expectedValue);
+            expectedValue += 1;
+        } else {
+            const auto count = queue.tryDequeueN(batch.data(), batchSize);
+            if (count == 0) {
+                std::this_thread::yield();
+            }
+            for (size_t i = 0; i < count; i += 1) {
+                isInOrder = isInOrder && (batch[i] == expectedValue);
+                expectedValue += 1;
+            }
+        }
+    }
+    producer.join();
+
+    int extraValue = 0;
+    const bool isEmpty = !queue.tryDequeue(extraValue);
+
+    if (isInOrder && isEmpty) {
+        std::cout << "[Correct] SPSCQueue capacity " << capacity << ", batch " << batchSize << ": " << elementsCount << " elements" << std::endl;
+    } else {
+        std::cout << "[Wrong] SPSCQueue capacity " << capacity << ", batch " << batchSize << ": in order " << isInOrder << ", empty at the end " << isEmpty << std::endl;
+    }
+}
+
+
+/// Every value must be dequeued exactly once, and each consumer must see each producer's values in order.
+void testMPMCQueue(const int producersCount, const int consumersCount, const size_t capacity, const WaitMode waitMode, const int valuesPerProducer) {
+    auto queue = MPMCQueue<int>(capacity, waitMode);
+
+    // Value = producerIndex * valuesPerProducer + i. -1 tells a consumer to stop.
+    auto producers = std::vector<std::thread>();
+    for (int producerIndex = 0; producerIndex < producersCount; producerIndex += 1) {
+        producers.emplace_back([&queue, producerIndex, valuesPerProducer]() {
+            for (int i = 0; i < valuesPerProducer; i += 1) {
+                queue.enqueue(producerIndex * valuesPerProducer + i);
+            }
+        });
+    }
+
+    auto receivedCounts = std::vector<std::atomic<int>>(static_cast<size_t>(producersCount) * valuesPerProducer);
+    auto isInOrder = std::atomic<bool>(true);
+    auto consumers = std::vector<std::thread>();
+    for (int consumerIndex = 0; consumerIndex < consumersCount; consumerIndex += 1) {
+        consumers.emplace_back([&queue, &receivedCounts, &isInOrder, producersCount, valuesPerProducer]() {
+            auto lastValues = std::vector<int>(producersCount, -1);
+            while (true) {
+                const int value = queue.dequeue();
+                if (value < 0) {
+                    break;
+                }
+
+                receivedCounts[value] += 1;
+                auto& lastValue = lastValues[value / valuesPerProducer];
+                if (value <= lastValue) {
+                    isInOrder = false;
+                }
+                lastValue = value;
+            }
+        });
+    }
+
+    for (auto& producer: producers) {
+        producer.join();
+    }
+    for (int i = 0; i < consumersCount; i += 1) {
+        queue.enqueue(-1);
+    }
+    for (auto& consumer: consumers) {
+        consumer.join();
+    }
+
+    const bool isExactlyOnce = std::all_of(receivedCounts.begin(), receivedCounts.end(), [](const std::atomic<int>& count) {
+        return count == 1;
+    });
+
+    const auto modeName = (waitMode == WaitMode::block)? "block": "spin";
+    if (isExactlyOnce && isInOrder) {
+        std::cout << "[Correct] MPMCQueue " << producersCount << " producers, " << consumersCount << " consumers, capacity " << capacity << ", " << modeName << std::endl;
+    } else {
+        std::cout << "[Wrong] MPMCQueue " << producersCount << " producers, " << consumersCount << " consumers, capacity " << capacity << ", " << modeName << ": exactly once " << isExactlyOnce << ", in order " << isInOrder << std::endl;
+    }
+}
+
+
+/// 1 consumer must dequeue every value once, in order for each producer.
+void testTwoStackMPSCQueue(const int producersCount, const int valuesPerProducer) {
+    auto queue = TwoStackMPSCQueue<int>();
+
+    auto producers = std::vector<std::thread>();
+    for (int producerIndex = 0; producerIndex < producersCount; producerIndex += 1) {
+        producers.emplace_back([&queue, producerIndex, valuesPerProducer]() {
+            for (int i = 0; i < valuesPerProducer; i += 1) {
+                queue.enqueue(producerIndex * valuesPerProducer + i);
+            }
+        });
+    }
+
+    // In order per producer and nothing lost implies exactly once.
+    auto nextValues = std::vector<int>(producersCount);
+    bool isCorrect = true;
+    for (long long i = 0; i < static_cast<long long>(producersCount) * valuesPerProducer; i += 1) {
+        const int value = queue.dequeue();
+        auto& nextValue = nextValues[value / valuesPerProducer];
+        if (value % valuesPerProducer != nextValue) {
+            isCorrect = false;
+        }
+        nextValue = value % valuesPerProducer + 1;
+    }
+    for (auto& producer: producers) {
+        producer.join();
+    }
+    int element = 0;
+    if (queue.tryDequeue(element)) {
+        isCorrect = false;
+    }
+
+    if (isCorrect) {
+        std::cout << "[Correct] TwoStackMPSCQueue " << producersCount << " producers" << std::endl;
+    } else {
+        std::cout << "[Wrong] TwoStackMPSCQueue " << producersCount << " producers" << std::endl;
+    }
+}
+
+
+#pragma mark - Benchmark
+/**
+ * `operationsCount` operations: bursts of `burstSize` enqueues followed by as many dequeues.
+ */
+template <typename Queue, typename Enqueue, typename Dequeue>
+void benchmarkQueue(benchmark::Runner& runner, const std::string& name, const long long operationsCount, const int burstSize, Enqueue enqueue, Dequeue dequeue) {
+    runner.run("queue, bursts of " + std::to_string(burstSize), name, operationsCount, [&]() {
+        auto queue = Queue();
+        long long checksum = 0;
+        for (long long i = 0; i < operationsCount; i += (2 * burstSize)) {
+            for (int j = 0; j < burstSize; j += 1) {
+                enqueue(queue, j);
+            }
+            for (int j = 0; j < burstSize; j += 1) {
+                checksum += dequeue(queue);
+            }
+        }
+        return checksum;
+    });
+}
+
+
+void benchmarkQueues(benchmark::Runner& runner, const long long operationsCount) {
+    for (const int burstSize: {1, 64, 4096}) {
+        benchmarkQueue<TwoStackQueue<int>>(runner, "TwoStackQueue", operationsCount, burstSize, [](TwoStackQueue<int>& queue, const int value) {
+            queue.enqueue(value);
+        }, [](TwoStackQueue<int>& queue) {
+            return queue.dequeue();
+        });
+        benchmarkQueue<std::queue<int>>(runner, "std::queue", operationsCount, burstSize, [](std::queue<int>& queue, const int value) {
+            queue.push(value);
+        }, [](std::queue<int>& queue) {
+            const auto returnValue = queue.front();
+            queue.pop();
+            return returnValue;
+        });
+        benchmarkQueue<std::deque<int>>(runner, "std::deque", operationsCount, burstSize, [](std::deque<int>& queue, const int value) {
+            queue.push_back(value);
+        }, [](std::deque<int>& queue) {
+            const auto returnValue = queue.front();
+            queue.pop_front();
+            return returnValue;
+        });
+    }
+}
+
+
+/// Producer → consumer throughput, with single or batched operations.
+void benchmarkSPSCQueueThroughput(benchmark::Runner& runner, const long long elementsCount, const size_t batchSize) {
+    runner.run("SPSCQueue throughput", "batch " + std::to_string(batchSize), elementsCount, [elementsCount, batchSize]() {
+        auto queue = SPSCQueue<long long>(1 << 16);
+
+        auto producer = std::thread([&queue, elementsCount, batchSize]() {
+            auto batch = std::vector<long long>(batchSize);
+            long long nextValue = 0;
+            while (nextValue < elementsCount) {
+                const auto count = static_cast<size_t>(std::min(static_cast<long long>(batchSize), elementsCount - nextValue));
+                for (size_t i = 0; i < count; i += 1) {
+                    batch[i] = nextValue + static_cast<long long>(i);
+                }
+
+                const auto enqueuedCount = queue.tryEnqueueN(batch.data(), count);
+                if (enqueuedCount == 0) {
+                    std::this_thread::yield();
+                }
+                nextValue += static_cast<long long>(enqueuedCount);
+            }
+        });
+
+        long long checksum = 0;
+        long long receivedCount = 0;
+        auto batch = std::vector<long long>(batchSize);
+        while (receivedCount < elementsCount) {
+            const auto count = queue.tryDequeueN(batch.data(), batchSize);
+            if (count == 0) {
+                std::this_thread::yield();
+            }
+            for (size_t i = 0; i < count; i += 1) {
+                checksum += batch[i];
+            }
+            receivedCount += static_cast<long long>(count);
+        }
+        producer.join();
+        return checksum;
+    });
+}
+
+
+/// Ping-pong over 2 queues: 1 element per one-way trip, so the time per element is the one-way latency.
+void benchmarkSPSCQueueLatency(benchmark::Runner& runner, const int roundTripsCount) {
+    runner.run("SPSCQueue latency", "ping-pong", 2LL * roundTripsCount, [roundTripsCount]() {
+        auto pings = SPSCQueue<int>(64);
+        auto pongs = SPSCQueue<int>(64);
+
+        auto responder = std::thread([&pings, &pongs, roundTripsCount]() {
+            for (int i = 0; i < roundTripsCount; i += 1) {
+                int value = 0;
+                while (!pings.tryDequeue(value)) {}
+                while (!pongs.tryEnqueue(value)) {}
+            }
+        });
+
+        long long checksum = 0;
+        for (int i = 0; i < roundTripsCount; i += 1) {
+            while (!pings.tryEnqueue(i)) {}
+            int value = 0;
+            while (!pongs.tryDequeue(value)) {}
+            checksum += value;
+        }
+        responder.join();
+        return checksum;
+    });
+}
+
+
+/// Contention benchmark: `threadsCount / 2` producers and as many consumers share 1 queue.
+void benchmarkMPMCQueue(benchmark::Runner& runner, const int threadsCount, const WaitMode waitMode, const int operationsCount) {
+    const int producersCount = std::max(1, threadsCount / 2);
+    const int consumersCount = std::max(1, threadsCount - producersCount);
+    const int valuesPerProducer = operationsCount / producersCount;
+
+    runner.run("MPMCQueue " + std::to_string(threadsCount) + " threads", (waitMode == WaitMode::block)? "block": "spin", static_cast<long long>(valuesPerProducer) * producersCount, [=]() {
+        auto queue = MPMCQueue<int>(1024, waitMode);
+        auto checksum = std::atomic<long long>(0);
+
+        auto threads = std::vector<std::thread>();
+        for (int i = 0; i < producersCount; i += 1) {
+            threads.emplace_back([&queue, valuesPerProducer]() {
+                for (int value = 0; value < valuesPerProducer; value += 1) {
+                    queue.enqueue(value);
+                }
+            });
+        }
+        for (int i = 0; i < consumersCount; i += 1) {
+            // Consumers share the work evenly; the first one takes the remainder.
+            const int valuesCount = (valuesPerProducer * producersCount) / consumersCount + ((i == 0)? ((valuesPerProducer * producersCount) % consumersCount): 0);
+            threads.emplace_back([&queue, &checksum, valuesCount]() {
+                long long localChecksum = 0;
+                for (int j = 0; j < valuesCount; j += 1) {
+                    localChecksum += queue.dequeue();
+                }
+                checksum += localChecksum;
+            });
+        }
+        for (auto& thread: threads) {
+            thread.join();
+        }
+        return checksum.load();
+    });
+}
+
+
+/// Many producers, 1 consumer: `TwoStackMPSCQueue` vs `MPMCQueue`.
+template <typename Queue>
+void benchmarkManyProducersOneConsumer(benchmark::Runner& runner, const std::string& name, const int producersCount, const int valuesPerProducer) {
+    runner.run("MPSC " + std::to_string(producersCount) + " producers", name, static_cast<long long>(producersCount) * valuesPerProducer, [producersCount, valuesPerProducer]() {
+        auto queue = Queue();
+
+        auto producers = std::vector<std::thread>();
+        for (int i = 0; i < producersCount; i += 1) {
+            producers.emplace_back([&queue, valuesPerProducer]() {
+                for (int value = 0; value < valuesPerProducer; value += 1) {
+                    queue.enqueue(value);
+                }
+            });
+        }
+        long long checksum = 0;
+        for (long long i = 0; i < static_cast<long long>(producersCount) * valuesPerProducer; i += 1) {
+            checksum += queue.dequeue();
+        }
+        for (auto& producer: producers) {
+            producer.join();
+        }
+        return checksum;
+    });
+}
+
+
+#pragma mark - Main
 int main() {
     std::unique_ptr<FakeQueue> fakeQueue (new FakeQueue());
     fakeQueue->enqueue(1);
@@ -69,5 +1123,54 @@ int main() {
     std::cout << fakeQueue->dequeue() << std::endl;
     std::cout << fakeQueue->dequeue() << std::endl;
 
+    testTwoStackQueue(1000000);
+
+    // Threads are started in every run: fewer repetitions.
+    auto runner = benchmark::Runner(benchmark::Options{1, 5, 2});
+
+    // 10^8 operations: BENCHMARK_SCALE=10.
+    benchmarkQueues(runner, benchmark::scaled(10000000));
+
+    testSPSCQueue(1, 1, 10000);
+    testSPSCQueue(1000, 1, 1000000);
+    testSPSCQueue(1024, 100, 1000000);
+
+    for (const size_t batchSize: {1, 16, 256}) {
+        benchmarkSPSCQueueThroughput(runner, benchmark::scaled(100000000), batchSize);
+    }
+    // Spins: only meaningful with at least 2 cores.
+    if (std::thread::hardware_concurrency() >= 2) {
+        benchmarkSPSCQueueLatency(runner, static_cast<int>(benchmark::scaled(1000000)));
+    }
+
+    for (const auto waitMode: {WaitMode::spin, WaitMode::block}) {
+        testMPMCQueue(1, 1, 2, waitMode, 100000);
+        testMPMCQueue(4, 4, 16, waitMode, 100000);
+        testMPMCQueue(8, 2, 1024, waitMode, 50000);
+        testMPMCQueue(2, 8, 4, waitMode, 50000);
+    }
+
+    for (const auto waitMode: {WaitMode::spin, WaitMode::block}) {
+        for (int threadsCount = 2; threadsCount <= 64; threadsCount *= 2) {
+            benchmarkMPMCQueue(runner, threadsCount, waitMode, static_cast<int>(benchmark::scaled(1000000)));
+        }
+    }
+
+    for (const int producersCount: {1, 2, 4, 8}) {
+        testTwoStackMPSCQueue(producersCount, 200000);
+    }
+
+    // Bounded: producers wait while it's full.
+    struct BoundedQueue: MPMCQueue<int> {
+        BoundedQueue(): MPMCQueue<int>(1024) {}
+    };
+    const auto mpscOperationsCount = static_cast<int>(benchmark::scaled(1000000));
+    for (const int producersCount: {1, 4, 16}) {
+        const int valuesPerProducer = std::max(1, mpscOperationsCount / producersCount);
+        benchmarkManyProducersOneConsumer<TwoStackMPSCQueue<int>>(runner, "TwoStackMPSCQueue", producersCount, valuesPerProducer);
+        benchmarkManyProducersOneConsumer<BoundedQueue>(runner, "MPMCQueue", producersCount, valuesPerProducer);
+    }
+    runner.writeFromEnvironment();
+
     return 0;
-}
\ No newline at end of file
+}
@@ -1,8 +1,15 @@
 #include <iostream>
 #include <vector>
 #include <algorithm>
+#include <thread>
+#include <random>
 
+#include "helpers/Benchmark.hpp"
+#include "helpers/Barrier.hpp"
+#include "helpers/PerfCounters.hpp"
 
+
+#pragma mark - 1. Single row
 int knapsack(const int totalCapacity, std::vector<int>& weights, std::vector<int>& values) {
     if (weights.size() == 0) {
         // No items.
@@ -11,6 +18,8 @@ int knapsack(const int totalCapacity, std::vector<int>& weights, std::vector<int
 
     auto capacityValues = std::vector<int>(totalCapacity + 1, 0);
 
+    // Around all capacity loops: 1 scope per item would cost more than short loops.
+    PERF_COUNTERS_SCOPE("knapsack capacity loops");
     // Iterate over all items: Previous items are included in `capacityValues` (so we don't count a single item twice).
     for (size_t i = 0; i < weights.size(); i += 1) {
         const auto weight = weights[i];
@@ -36,6 +45,70 @@ int knapsack(const int totalCapacity, std::vector<int>& weights, std::vector<int
 }
 
 
+#pragma mark - 2. Multi-threaded
+/*
+ * Each item's pass only reads the previous item's row.
+ * With 2 rows (double buffering), the capacity range can therefore be split across threads without races.
+ *
+ * Notes:
+ * - Each thread owns a contiguous capacity range, and all threads sync on a barrier after each item.
+ * - Items cannot be blocked per thread: `capacity - weight` usually falls into another thread's range, which must have finished the previous item.
+ */
+int knapsackMultiThreaded(const int totalCapacity, const std::vector<int>& weights, const std::vector<int>& values, int threadsCount) {
+    if (weights.size() == 0) {
+        // No items.
+        return 0;
+    }
+
+    // Each thread needs at least 1 capacity.
+    threadsCount = std::max(1, std::min(threadsCount, totalCapacity + 1));
+
+    // Item `i` reads from `rows[i % 2]` and writes to `rows[(i + 1) % 2]`.
+    std::vector<int> rows[2] = {std::vector<int>(totalCapacity + 1, 0), std::vector<int>(totalCapacity + 1, 0)};
+
+    auto barrier = Barrier(threadsCount);
+
+    auto worker = [&](const int threadIndex) {
+        // [rangeBegin, rangeEnd)
+        const int rangeBegin = static_cast<int>(static_cast<long long>(totalCapacity + 1) * threadIndex / threadsCount);
+        const int rangeEnd = static_cast<int>(static_cast<long long>(totalCapacity + 1) * (threadIndex + 1) / threadsCount);
+
+        for (size_t i = 0; i < weights.size(); i += 1) {
+            const auto weight = weights[i];
+            const auto value = values[i];
+
+            const auto& previousValues = rows[i % 2];
+            auto& currentValues = rows[(i + 1) % 2];
+
+            // Cannot fit current item into the knapsack: copy the previous row.
+            const int fitBegin = std::min(std::max(rangeBegin, weight), rangeEnd);
+            std::copy(previousValues.begin() + rangeBegin, previousValues.begin() + fitBegin, currentValues.begin() + rangeBegin);
+
+            // Any order works here because we never read `currentValues`.
+            for (int capacity = fitBegin; capacity < rangeEnd; capacity += 1) {
+                const int newValue = previousValues[capacity - weight] + value;
+                currentValues[capacity] = std::max(newValue, previousValues[capacity]);
+            }
+
+            // Wait for the whole row before the next item reads it.
+            barrier.wait();
+        }
+    };
+
+    auto allThreads = std::vector<std::thread>();
+    for (int threadIndex = 1; threadIndex < threadsCount; threadIndex += 1) {
+        allThreads.emplace_back(worker, threadIndex);
+    }
+    worker(0);    // The current thread also does some work.
+    for (auto& aThread: allThreads) {
+        aThread.join();
+    }
+
+    return rows[weights.size() % 2].back();
+}
+
+
+#pragma mark - Tests
 void test(const int capacity, const std::vector<int>& weights, const std::vector<int>& values, const int expectedResult) {
     auto weightsCopy = weights;
     auto valuesCopy = values;
@@ -46,6 +119,65 @@ void test(const int capacity, const std::vector<int>& weights, const std::vector
     } else {
         std::cout << "Incorrect: " << result << " (should be " << expectedResult << ")" << std::endl;
     }
+
+    for (const int threadsCount: {1, 2, 3, 8}) {
+        auto multiThreadedResult = knapsackMultiThreaded(capacity, weights, values, threadsCount);
+        if (multiThreadedResult == expectedResult) {
+            std::cout << "Correct! (" << threadsCount << " threads)" << std::endl;
+        } else {
+            std::cout << "Incorrect: " << multiThreadedResult << " (should be " << expectedResult << ", " << threadsCount << " threads)" << std::endl;
+        }
+    }
+}
+
+
+#pragma mark - Benchmark
+/**
+ * Scaling benchmark of `knapsackMultiThreaded`, 1 variant per thread count. Elements: cell updates.
+ *
+ * The full-size instance (10^4 items, 10^7 capacity) is 10^11 cell updates: run it with `benchmarkMultiThreaded(runner, 10000, 10000000, 64)`.
+ */
+void benchmarkMultiThreaded(benchmark::Runner& runner, const int itemsCount, const int totalCapacity, const int maxThreadsCount) {
+    auto generator = std::mt19937(42);
+    auto weightDistribution = std::uniform_int_distribution<>(1, std::max(1, totalCapacity / 10));
+    auto valueDistribution = std::uniform_int_distribution<>(1, 1000);
+
+    auto weights = std::vector<int>(itemsCount);
+    auto values = std::vector<int>(itemsCount);
+    std::generate(weights.begin(), weights.end(), [&]() { return weightDistribution(generator); });
+    std::generate(values.begin(), values.end(), [&]() { return valueDistribution(generator); });
+
+    const auto expectedResult = knapsackMultiThreaded(totalCapacity, weights, values, 1);
+
+    const auto group = "knapsackMultiThreaded scaling, " + std::to_string(itemsCount) + " items, " + std::to_string(totalCapacity) + " capacity";
+    for (int threadsCount = 1; threadsCount <= maxThreadsCount; threadsCount *= 2) {
+        int result = 0;
+        runner.run(group, std::to_string(threadsCount) + " threads", static_cast<long long>(itemsCount) * totalCapacity, [&]() {
+            result = knapsackMultiThreaded(totalCapacity, weights, values, threadsCount);
+            return result;
+        });
+
+        if (result != expectedResult) {
+            std::cout << "Incorrect: " << result << " (should be " << expectedResult << ", " << threadsCount << " threads)" << std::endl;
+        }
+    }
+}
+
+
+/// `knapsack` vs. `knapsackMultiThreaded` on every core. Elements: cell updates.
+void benchmarkKnapsack(benchmark::Runner& runner) {
+    const auto itemsCount = benchmark::scaled(1000);
+    const int totalCapacity = 100000;
+    auto weights = benchmark::generateRandomIntegers(itemsCount, 1, totalCapacity / 10);
+    auto values = benchmark::generateRandomIntegers(itemsCount, 1, 1000, 43);
+    const int threadsCount = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+
+    runner.run("knapsack", "knapsack", itemsCount * totalCapacity, [&]() {
+        return knapsack(totalCapacity, weights, values);
+    });
+    runner.run("knapsack", "knapsackMultiThreaded (" + std::to_string(threadsCount) + " threads)", itemsCount * totalCapacity, [&]() {
+        return knapsackMultiThreaded(totalCapacity, weights, values, threadsCount);
+    });
 }
 
 
@@ -57,5 +189,12 @@ int main() {
     test(3, {4,5,6}, {1,2,3}, 0);
     test(8, {4,5,1,7}, {1,2,3,4}, 3+4);
 
+    auto runner = benchmark::Runner();
+    benchmarkMultiThreaded(runner, static_cast<int>(benchmark::scaled(1000)), 100000, 64);
+    benchmarkKnapsack(runner);
+    runner.writeFromEnvironment();
+
+    PERF_COUNTERS_REPORT(std::cout);
+
     return 0;
 }
@@ -4,6 +4,9 @@
 
 #include <iostream>
 #include <vector>
+#include <cmath>
+
+#include "helpers/Benchmark.hpp"
 
 
 #pragma mark - Helpers
@@ -51,9 +54,26 @@ void calculatePrimeNumbers(int n) {
 }
 
 
+#pragma mark - Benchmark
+void benchmarkPrimeNumbers(benchmark::Runner& runner) {
+    const auto n = benchmark::scaled(100000);
+    runner.run("prime_numbers", "calculatePrimeNumbers", n, []() {
+        // Start over every time.
+        primeNumbers = std::vector<int>({2, 3});
+    }, [n]() {
+        calculatePrimeNumbers(static_cast<int>(n));
+        return primeNumbers.back();
+    });
+}
+
+
 int main() {
     calculatePrimeNumbers(100000);
     std::cout << primeNumbers << std::endl;
 
+    auto runner = benchmark::Runner();
+    benchmarkPrimeNumbers(runner);
+    runner.writeFromEnvironment();
+
     return 0;
 }
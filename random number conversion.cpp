@@ -6,66 +6,700 @@
 #include <thread>
 #include <vector>
 #include <map>
+#include <array>
+#include <cstdint>
+#include <random>
+#include <string>
+#include <cstdlib>
+#include <cmath>
+#include <stdexcept>
+#include <atomic>
 
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
 
-void convertRandomNumbersTest() {
-    std::vector<int> results (9, 0);
-    for (int i = 0; i < 10000000; i += 1) {
-        int sourceRandomNumber = arc4random() % 4;
+#include "helpers/Benchmark.hpp"
 
-        int destinationIndex = arc4random() % 3;
 
-        std::vector<int> destinationNumbersCandidates;
+#pragma mark - Engines
+/*
+ * xoshiro256** by David Blackman and Sebastiano Vigna: 256 bits of state, a few shifts and rotations per number.
+ *
+ * https://prng.di.unimi.it/xoshiro256starstar.c
+ *
+ * Meets the standard `UniformRandomBitGenerator` requirements, so it plugs into `<random>` distributions.
+ * One engine per thread: no locking, unlike `arc4random()`.
+ */
+class Xoshiro256StarStar {
+public:
+    using result_type = uint64_t;
 
-        switch (sourceRandomNumber) {
-        case 0:
-            destinationNumbersCandidates = {0, 4, 2};
-            break;
+private:
+    std::array<uint64_t, 4> state;
 
-        case 1:
-            destinationNumbersCandidates = {1, 5, 3};
-            break;
+public:
+    /// Expands `seed` with SplitMix64, as recommended by the authors.
+    explicit Xoshiro256StarStar(uint64_t seed = 0) {
+        for (auto& word: state) {
+            seed += 0x9e3779b97f4a7c15;
+            uint64_t z = seed;
+            z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9;
+            z = (z ^ (z >> 27)) * 0x94d049bb133111eb;
+            word = z ^ (z >> 31);
+        }
+    }
 
-        case 2:
-            destinationNumbersCandidates = {2, 0, 4};
-            break;
+    explicit Xoshiro256StarStar(const std::array<uint64_t, 4>& state): state(state) {
+    }
 
-        case 3:
-            destinationNumbersCandidates = {3, 1, 5};
-            break;
-        
-        default:
-            destinationNumbersCandidates = {6, 7, 8};    // Failsafe.
-            break;
+public:
+    static constexpr result_type min() {
+        return 0;
+    }
+
+    static constexpr result_type max() {
+        return UINT64_MAX;
+    }
+
+    result_type operator()() {
+        const uint64_t returnValue = rotateLeft(state[1] * 5, 7) * 9;
+
+        const uint64_t t = state[1] << 17;
+        state[2] ^= state[0];
+        state[3] ^= state[1];
+        state[1] ^= state[2];
+        state[0] ^= state[3];
+        state[2] ^= t;
+        state[3] = rotateLeft(state[3], 45);
+
+        return returnValue;
+    }
+
+    /// Same as 2^128 calls: gives up to 2^128 non-overlapping streams, 1 per thread.
+    void jump() {
+        static const uint64_t JUMP[] = {0x180ec6d33cfd0aba, 0xd5a61266f0c9392c, 0xa9582618e03fc9aa, 0x39abdc4529b1661c};
+
+        auto jumpedState = std::array<uint64_t, 4>{0, 0, 0, 0};
+        for (const auto jumpWord: JUMP) {
+            for (int bit = 0; bit < 64; bit += 1) {
+                if (jumpWord & (uint64_t(1) << bit)) {
+                    for (int i = 0; i < 4; i += 1) {
+                        jumpedState[i] ^= state[i];
+                    }
+                }
+                (*this)();
+            }
         }
+        state = jumpedState;
+    }
 
-        results.at(destinationNumbersCandidates.at(destinationIndex)) += 1;
+private:
+    static uint64_t rotateLeft(const uint64_t x, const int k) {
+        return (x << k) | (x >> (64 - k));
     }
+};
 
-    for (const int& aNumber: results) {
-        std::cout << aNumber << " ";
+
+#if defined(__APPLE__) || defined(__FreeBSD__) || defined(__OpenBSD__)
+/// The previous source, for comparison where it exists.
+struct Arc4random {
+    using result_type = uint32_t;
+
+    static constexpr result_type min() {
+        return 0;
     }
-    std::cout << std::endl;
+
+    static constexpr result_type max() {
+        return UINT32_MAX;
+    }
+
+    result_type operator()() {
+        return arc4random();
+    }
+};
+#endif
+
+
+#pragma mark - Conversion
+/// `DESTINATION_NUMBERS[sourceRandomNumber][destinationIndex]`: each of 0...5 appears twice, so a uniform pair gives a uniform number.
+static const int DESTINATION_NUMBERS[4][3] = {
+    {0, 4, 2},
+    {1, 5, 3},
+    {2, 0, 4},
+    {3, 1, 5},
+};
+
+
+/// `sourceRandomNumber` and `destinationIndex` come from the 2 halves of 1 64-bit draw, like 2 32-bit `arc4random()` calls.
+template <typename Engine>
+int convertRandomNumber(Engine& engine) {
+    uint64_t randomBits = engine();
+    if (Engine::max() <= UINT32_MAX) {
+        randomBits = (randomBits << 32) | engine();
+    }
+
+    const int sourceRandomNumber = static_cast<uint32_t>(randomBits) % 4;
+    const int destinationIndex = static_cast<uint32_t>(randomBits >> 32) % 3;
+
+    return DESTINATION_NUMBERS[sourceRandomNumber][destinationIndex];
 }
 
-int main() {
-    // std::thread thread1 (convertRandomNumbersTest);
-    // std::thread thread2 (convertRandomNumbersTest);
-    // std::thread thread3 (convertRandomNumbersTest);
-    // std::thread thread4 (convertRandomNumbersTest);
-    // thread1.join();
-    // thread2.join();
-    // thread3.join();
-    // thread4.join();
+
+/// Counts the numbers generated in `iterationsCount` conversions. No allocation in the loop.
+template <typename Engine>
+std::array<long long, 6> convertRandomNumbers(Engine& engine, const int iterationsCount) {
+    auto results = std::array<long long, 6>{};
+    for (int i = 0; i < iterationsCount; i += 1) {
+        results[convertRandomNumber(engine)] += 1;
+    }
+    return results;
+}
+
+
+void jump(Xoshiro256StarStar& engine) {
+    engine.jump();
+}
+
+/// No jump-ahead: reseed from the engine itself.
+void jump(std::mt19937_64& engine) {
+    engine.seed(engine());
+}
+
+#if defined(__APPLE__) || defined(__FreeBSD__) || defined(__OpenBSD__)
+/// Shared global state: nothing to do.
+void jump(Arc4random&) {
+}
+#endif
+
+
+/// Each thread runs on its own engine, `jump()`ed from the previous thread's one.
+template <typename Engine>
+void convertRandomNumbersTest(const std::string& engineName, Engine engine, const int iterationsCount) {
+    auto allResults = std::vector<std::array<long long, 6>>(THREADS_COUNT);
 
     std::vector<std::thread> allThreads;
     for (int i = 0; i < THREADS_COUNT; i += 1) {
-        std::thread currentThread (convertRandomNumbersTest);
-        allThreads.push_back(std::move(currentThread));
+        allThreads.emplace_back([engine, &allResults, i, iterationsCount]() mutable {
+            allResults[i] = convertRandomNumbers(engine, iterationsCount);
+        });
+        jump(engine);
     }
-    for (int i = 0; i < THREADS_COUNT; i += 1) {
-        allThreads.at(i).join();
+    for (auto& thread: allThreads) {
+        thread.join();
+    }
+
+    // Each number should come up 1/6 of the time: allow 6 standard deviations.
+    bool isUniform = true;
+    for (const auto& results: allResults) {
+        const double expectedCount = iterationsCount / 6.0;
+        for (const auto count: results) {
+            if (std::abs(count - expectedCount) > 6 * std::sqrt(expectedCount * 5 / 6)) {
+                isUniform = false;
+            }
+        }
+    }
+
+    std::cout << (isUniform? "[Correct] ": "[Wrong] ") << engineName << ", " << THREADS_COUNT << " threads: ";
+    for (const auto& results: allResults) {
+        for (const long long aNumber: results) {
+            std::cout << aNumber << " ";
+        }
+        std::cout << "| ";
     }
+    std::cout << std::endl;
+}
+
+
+#pragma mark - Sharded histogram
+static const size_t CACHE_LINE_SIZE = 64;
+
+/*
+ * Histogram written by many threads at once: 1 shard per thread, each starting on its own cache line.
+ *
+ * - A shard has a single writer, so `increment` is a plain load and store (no locked instruction), and no cache line is shared between writers.
+ * - `merge` sums the shards: at the end, or on demand while writers are running (then a recent but not atomic snapshot).
+ */
+class ShardedHistogram {
+private:
+    using Counter = std::atomic<long long>;
+    static const size_t COUNTERS_PER_LINE = CACHE_LINE_SIZE / sizeof(Counter);
+
+    struct alignas(CACHE_LINE_SIZE) CacheLine {
+        Counter counters[COUNTERS_PER_LINE];
+    };
+
+    size_t bucketsCount;
+    size_t shardsCount;
+    size_t linesPerShard;
+    std::vector<CacheLine> lines;
+
+public:
+    ShardedHistogram(const size_t bucketsCount, const size_t shardsCount): bucketsCount(bucketsCount), shardsCount(shardsCount), linesPerShard((bucketsCount + COUNTERS_PER_LINE - 1) / COUNTERS_PER_LINE), lines(linesPerShard * shardsCount) {
+        for (auto& line: lines) {
+            for (auto& counter: line.counters) {
+                counter.store(0, std::memory_order_relaxed);
+            }
+        }
+    }
+
+public:
+    size_t getBucketsCount() const {
+        return bucketsCount;
+    }
+
+    size_t getShardsCount() const {
+        return shardsCount;
+    }
+
+    /// Only the thread owning `shardIndex` may call it.
+    void increment(const size_t shardIndex, const size_t bucket, const long long count = 1) {
+        auto& counter = getCounter(shardIndex, bucket);
+        counter.store(counter.load(std::memory_order_relaxed) + count, std::memory_order_relaxed);
+    }
+
+    std::vector<long long> getShard(const size_t shardIndex) const {
+        auto returnValue = std::vector<long long>(bucketsCount);
+        for (size_t bucket = 0; bucket < bucketsCount; bucket += 1) {
+            returnValue[bucket] = getCounter(shardIndex, bucket).load(std::memory_order_relaxed);
+        }
+        return returnValue;
+    }
+
+    std::vector<long long> merge() const {
+        auto returnValue = std::vector<long long>(bucketsCount, 0);
+        for (size_t shardIndex = 0; shardIndex < shardsCount; shardIndex += 1) {
+            for (size_t bucket = 0; bucket < bucketsCount; bucket += 1) {
+                returnValue[bucket] += getCounter(shardIndex, bucket).load(std::memory_order_relaxed);
+            }
+        }
+        return returnValue;
+    }
+
+private:
+    Counter& getCounter(const size_t shardIndex, const size_t bucket) {
+        return lines[shardIndex * linesPerShard + bucket / COUNTERS_PER_LINE].counters[bucket % COUNTERS_PER_LINE];
+    }
+
+    const Counter& getCounter(const size_t shardIndex, const size_t bucket) const {
+        return lines[shardIndex * linesPerShard + bucket / COUNTERS_PER_LINE].counters[bucket % COUNTERS_PER_LINE];
+    }
+};
+
+
+/// Distribution of a merged histogram against the uniform one.
+struct HistogramStatistics {
+    long long totalCount = 0;
+    double chiSquare = 0;
+    /// Largest |frequency / expected frequency - 1|.
+    double maxRelativeDeviation = 0;
+
+    explicit HistogramStatistics(const std::vector<long long>& counts) {
+        for (const auto count: counts) {
+            totalCount += count;
+        }
+
+        const double expectedCount = static_cast<double>(totalCount) / counts.size();
+        for (const auto count: counts) {
+            chiSquare += (count - expectedCount) * (count - expectedCount) / expectedCount;
+            maxRelativeDeviation = std::max(maxRelativeDeviation, std::abs(count / expectedCount - 1));
+        }
+    }
+
+    /// Within 6 standard deviations of the chi-square mean (normal approximation).
+    bool isUniform(const size_t bucketsCount) const {
+        const double degreesOfFreedom = bucketsCount - 1;
+        return chiSquare <= degreesOfFreedom + 6 * std::sqrt(2 * degreesOfFreedom);
+    }
+};
+
+
+/**
+ * Runs `iterationsPerThread` conversions on each of `threadsCount` threads (`hardware_concurrency` if 0), counting into 1 shared histogram.
+ *
+ * @return The merged counts.
+ */
+template <typename Engine>
+std::vector<long long> runConversion(Engine engine, const long long iterationsPerThread, size_t threadsCount = 0) {
+    if (threadsCount == 0) {
+        threadsCount = std::max<size_t>(std::thread::hardware_concurrency(), 1);
+    }
+    auto histogram = ShardedHistogram(6, threadsCount);
+
+    auto allThreads = std::vector<std::thread>();
+    for (size_t i = 0; i < threadsCount; i += 1) {
+        allThreads.emplace_back([engine, &histogram, i, iterationsPerThread]() mutable {
+            for (long long j = 0; j < iterationsPerThread; j += 1) {
+                histogram.increment(i, convertRandomNumber(engine));
+            }
+        });
+        jump(engine);
+    }
+    for (auto& thread: allThreads) {
+        thread.join();
+    }
+
+    return histogram.merge();
+}
+
+
+#pragma mark - Bulk range reduction
+/*
+ * Exact bulk conversion of uniform samples in [0, k) to uniform numbers in [0, n), in 2 stages.
+ *
+ * 1. Packing: samples go into an accumulator `value`, uniform in [0, `range`), as `value * k + sample`.
+ *    Once `range` is about to overflow, the low 32 bits are a uniform word if `value` is below the largest multiple of 2^32 in `range`.
+ *    Either way, what's left stays uniform in a smaller range and is kept: no entropy is thrown away, and powers of 2 never reject.
+ * 2. Reduction (Daniel Lemire, "Fast Random Integer Generation in an Interval"): `word * n` is 64 bits,
+ *    its high half is the result and its low half rejects the few words that would bias it (below 2^32 mod n).
+ *    With AVX2, 8 words at once, and the accepted results are packed with a permutation table.
+ *
+ * https://arxiv.org/abs/1805.10941
+ */
+class UniformRangeReducer {
+private:
+    static const uint64_t WORD_RANGE = uint64_t(1) << 32;
+
+    uint32_t sourceRange;
+    uint32_t destinationRange;
+    /// Words below it are rejected: 2^32 mod n.
+    uint32_t threshold;
+    /// Largest `range` that can take 1 more sample.
+    uint64_t maxRange;
+
+    /// Packing accumulator: `value` is uniform in [0, `range`).
+    uint64_t value = 0;
+    uint64_t range = 1;
+
+    /// Words between the 2 stages of `convert`.
+    std::vector<uint32_t> words;
+
+public:
+    /// @param sourceRange k >= 2. @param destinationRange n >= 1.
+    UniformRangeReducer(const uint32_t sourceRange, const uint32_t destinationRange): sourceRange(sourceRange), destinationRange(destinationRange), threshold(0), maxRange(0) {
+        if ((sourceRange < 2) || (destinationRange < 1)) {
+            throw std::invalid_argument("UniformRangeReducer: needs k >= 2 and n >= 1");
+        }
+        threshold = static_cast<uint32_t>(WORD_RANGE % destinationRange);
+        maxRange = UINT64_MAX / sourceRange;
+    }
+
+public:
+    /// Most numbers `convert` can write for `samplesCount` samples: each word takes at least 32 bits, and each sample brings at most log2(k).
+    size_t getMaxOutputCount(const size_t samplesCount) const {
+        return static_cast<size_t>(std::ceil(samplesCount * std::log2(static_cast<double>(sourceRange)) / 32)) + 1;
+    }
+
+    /**
+     * Packs samples into uniform 32-bit words. The accumulator carries over to the next call.
+     *
+     * @param output Room for `getMaxOutputCount(samplesCount)` words.
+     * @return Words written.
+     */
+    size_t pack(const uint32_t* samples, const size_t samplesCount, uint32_t* output) {
+        size_t outputCount = 0;
+        for (size_t i = 0; i < samplesCount; i += 1) {
+            value = value * sourceRange + samples[i];
+            range *= sourceRange;
+
+            // Only once `range * k` wouldn't fit: with `range` close to 2^64, rejections are rare and what's left is large.
+            if (range > maxRange) {
+                const uint64_t limit = range - range % WORD_RANGE;
+                if (value < limit) {
+                    output[outputCount] = static_cast<uint32_t>(value);
+                    outputCount += 1;
+                    value >>= 32;
+                    range = limit >> 32;
+                } else {
+                    value -= limit;
+                    range -= limit;
+                }
+            }
+        }
+        return outputCount;
+    }
+
+    /**
+     * Reduces uniform 32-bit words to [0, n).
+     *
+     * @param output Room for `wordsCount` numbers.
+     * @return Numbers written: `wordsCount` minus the rejected words.
+     */
+    size_t reduce(const uint32_t* words, const size_t wordsCount, uint32_t* output) const {
+        size_t outputCount = 0;
+        size_t i = 0;
+
+#if defined(__AVX2__)
+        const auto& permutations = getLeftPackPermutations();
+        const __m256i destinationRangeVector = _mm256_set1_epi64x(destinationRange);
+        const __m256i thresholdVector = _mm256_set1_epi32(static_cast<int>(threshold));
+        for (; i + 8 <= wordsCount; i += 8) {
+            const __m256i wordVector = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(words + i));
+            // Products of the even and odd lanes.
+            const __m256i evenProducts = _mm256_mul_epu32(wordVector, destinationRangeVector);
+            const __m256i oddProducts = _mm256_mul_epu32(_mm256_srli_epi64(wordVector, 32), destinationRangeVector);
+            const __m256i lows = _mm256_blend_epi32(evenProducts, _mm256_slli_epi64(oddProducts, 32), 0b10101010);
+            const __m256i highs = _mm256_blend_epi32(_mm256_srli_epi64(evenProducts, 32), oddProducts, 0b10101010);
+
+            // Unsigned `low >= threshold`.
+            const __m256i isAccepted = _mm256_cmpeq_epi32(_mm256_max_epu32(lows, thresholdVector), lows);
+            const int mask = _mm256_movemask_ps(_mm256_castsi256_ps(isAccepted));
+
+            // Accepted lanes first. Writes 8 lanes, but `outputCount + 8 <= i + 8 <= wordsCount`.
+            const __m256i permutation = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(permutations[mask].data()));
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(output + outputCount), _mm256_permutevar8x32_epi32(highs, permutation));
+            outputCount += __builtin_popcount(mask);
+        }
+#endif
+
+        outputCount += reduceScalar(words + i, wordsCount - i, output + outputCount);
+        return outputCount;
+    }
+
+    /// Same as `reduce`, without AVX2.
+    size_t reduceScalar(const uint32_t* words, const size_t wordsCount, uint32_t* output) const {
+        size_t outputCount = 0;
+        for (size_t i = 0; i < wordsCount; i += 1) {
+            const uint64_t product = uint64_t(words[i]) * destinationRange;
+            // Branch-free: always write, only keep accepted numbers.
+            output[outputCount] = static_cast<uint32_t>(product >> 32);
+            outputCount += (static_cast<uint32_t>(product) >= threshold);
+        }
+        return outputCount;
+    }
+
+    /**
+     * `pack`, then `reduce`.
+     *
+     * @param output Room for `getMaxOutputCount(samplesCount)` numbers.
+     * @return Numbers written.
+     */
+    size_t convert(const uint32_t* samples, const size_t samplesCount, uint32_t* output) {
+        words.resize(getMaxOutputCount(samplesCount));
+        const size_t wordsCount = pack(samples, samplesCount, words.data());
+        return reduce(words.data(), wordsCount, output);
+    }
+
+private:
+#if defined(__AVX2__)
+    /// `[mask]`: indices of the set bits of `mask`, then the others.
+    static const std::array<std::array<uint32_t, 8>, 256>& getLeftPackPermutations() {
+        static const auto permutations = []() {
+            auto returnValue = std::array<std::array<uint32_t, 8>, 256>();
+            for (int mask = 0; mask < 256; mask += 1) {
+                int count = 0;
+                for (int lane = 0; lane < 8; lane += 1) {
+                    if (mask & (1 << lane)) {
+                        returnValue[mask][count] = lane;
+                        count += 1;
+                    }
+                }
+                for (int lane = 0; lane < 8; lane += 1) {
+                    if (!(mask & (1 << lane))) {
+                        returnValue[mask][count] = lane;
+                        count += 1;
+                    }
+                }
+            }
+            return returnValue;
+        }();
+        return permutations;
+    }
+#endif
+};
+
+
+#pragma mark - Tests
+/// First outputs of the reference implementation from state {1, 2, 3, 4}.
+void testXoshiro256StarStar() {
+    auto engine = Xoshiro256StarStar(std::array<uint64_t, 4>{1, 2, 3, 4});
+    const auto expectedResults = std::vector<uint64_t>{11520, 0, 1509978240, 1215971899390074240};
+
+    auto results = std::vector<uint64_t>();
+    for (size_t i = 0; i < expectedResults.size(); i += 1) {
+        results.push_back(engine());
+    }
+
+    if (results == expectedResults) {
+        std::cout << "[Correct] Xoshiro256StarStar" << std::endl;
+    } else {
+        std::cout << "[Wrong] Xoshiro256StarStar" << std::endl;
+    }
+}
+
+
+/// Random samples in [0, k), from 1 engine.
+std::vector<uint32_t> generateSamples(const uint32_t sourceRange, const size_t samplesCount, const uint64_t seed) {
+    auto engine = Xoshiro256StarStar(seed);
+    auto samples = std::vector<uint32_t>(samplesCount);
+    for (auto& sample: samples) {
+        // Lemire's reduction of a 64-bit number: bias below 2^-32, negligible for a test source.
+        sample = static_cast<uint32_t>((static_cast<__uint128_t>(engine()) * sourceRange) >> 64);
+    }
+    return samples;
+}
+
+
+/**
+ * Chi-square test of `convert`'s output, and `reduce` vs. `reduceScalar`.
+ *
+ * With n - 1 degrees of freedom, the statistic is about normal with mean n - 1 and variance 2(n - 1): allow 6 standard deviations.
+ */
+void testUniformRangeReducer(const uint32_t sourceRange, const uint32_t destinationRange, const size_t samplesCount) {
+    const auto samples = generateSamples(sourceRange, samplesCount, sourceRange * 1000003ULL + destinationRange);
+
+    auto reducer = UniformRangeReducer(sourceRange, destinationRange);
+    auto output = std::vector<uint32_t>(reducer.getMaxOutputCount(samplesCount));
+    // In 2 calls: the accumulator must carry over.
+    size_t outputCount = reducer.convert(samples.data(), samplesCount / 2, output.data());
+    outputCount += reducer.convert(samples.data() + samplesCount / 2, samplesCount - samplesCount / 2, output.data() + outputCount);
+
+    auto counts = std::vector<long long>(destinationRange, 0);
+    bool isInRange = true;
+    for (size_t i = 0; i < outputCount; i += 1) {
+        if (output[i] >= destinationRange) {
+            isInRange = false;
+            break;
+        }
+        counts[output[i]] += 1;
+    }
+
+    const double expectedCount = static_cast<double>(outputCount) / destinationRange;
+    double chiSquare = 0;
+    for (const auto count: counts) {
+        chiSquare += (count - expectedCount) * (count - expectedCount) / expectedCount;
+    }
+    const double degreesOfFreedom = destinationRange - 1;
+    const bool isUniform = (chiSquare <= degreesOfFreedom + 6 * std::sqrt(2 * degreesOfFreedom));
+
+    // Entropy: about log2(k) / 32 words per sample.
+    const double expectedOutputCount = samplesCount * std::log2(static_cast<double>(sourceRange)) / 32;
+    const bool isEfficient = (outputCount >= expectedOutputCount * 0.99 - 2);
+
+    auto words = std::vector<uint32_t>(samples.begin(), samples.end());
+    for (auto& word: words) {
+        word = word * 2654435761u;
+    }
+    auto vectorOutput = std::vector<uint32_t>(words.size());
+    auto scalarOutput = std::vector<uint32_t>(words.size());
+    vectorOutput.resize(reducer.reduce(words.data(), words.size(), vectorOutput.data()));
+    scalarOutput.resize(reducer.reduceScalar(words.data(), words.size(), scalarOutput.data()));
+    const bool isSameAsScalar = (vectorOutput == scalarOutput);
+
+    if (isInRange && isUniform && isEfficient && isSameAsScalar) {
+        std::cout << "[Correct] UniformRangeReducer [0, " << sourceRange << ") -> [0, " << destinationRange << "): " << outputCount << " numbers, chi-square " << chiSquare << std::endl;
+    } else {
+        std::cout << "[Wrong] UniformRangeReducer [0, " << sourceRange << ") -> [0, " << destinationRange << "): " << outputCount << " numbers, chi-square " << chiSquare << ", in range " << isInRange << ", uniform " << isUniform << ", efficient " << isEfficient << ", same as scalar " << isSameAsScalar << std::endl;
+    }
+}
+
+
+/// `runConversion` on every core: the merged histogram must be uniform.
+template <typename Engine>
+void testRunConversion(const std::string& engineName, const Engine& engine, const long long iterationsPerThread) {
+    const size_t threadsCount = std::max<size_t>(std::thread::hardware_concurrency(), 1);
+    const auto counts = runConversion(engine, iterationsPerThread, threadsCount);
+    const auto statistics = HistogramStatistics(counts);
+
+    std::cout << (statistics.isUniform(counts.size())? "[Correct] ": "[Wrong] ") << engineName << ", " << threadsCount << " threads, sharded histogram: ";
+    for (const long long aNumber: counts) {
+        std::cout << aNumber << " ";
+    }
+    std::cout << "| chi-square " << statistics.chiSquare << ", max deviation " << (statistics.maxRelativeDeviation * 100) << "%" << std::endl;
+}
+
+
+#pragma mark - Benchmark
+/// Single-threaded `convertRandomNumbers`: the cost of the engine plus the table lookup.
+template <typename Engine>
+void benchmarkConvertRandomNumbers(benchmark::Runner& runner, const std::string& engineName, const Engine& engine, const int iterationsCount) {
+    auto threadEngine = engine;
+    runner.run("convertRandomNumbers", engineName, iterationsCount, [&]() {
+        return convertRandomNumbers(threadEngine, iterationsCount)[0];
+    });
+}
+
+
+/// `runConversion` from 1 thread to `hardware_concurrency` (at least 4), with the speedup over 1 thread (same work per thread).
+template <typename Engine>
+void benchmarkConversionScaling(benchmark::Runner& runner, const std::string& engineName, const Engine& engine, const long long iterationsPerThread) {
+    const size_t maxThreadsCount = std::max<size_t>(std::thread::hardware_concurrency(), 4);
+    double singleThreadNanoseconds = 0;
+    for (size_t threadsCount = 1; threadsCount <= maxThreadsCount; threadsCount *= 2) {
+        const auto result = runner.run("runConversion " + engineName, std::to_string(threadsCount) + " threads", iterationsPerThread * static_cast<long long>(threadsCount), [&]() {
+            return runConversion(engine, iterationsPerThread, threadsCount)[0];
+        });
+        if (threadsCount == 1) {
+            singleThreadNanoseconds = result.getMedianNanoseconds();
+        }
+        std::cout << "    speedup " << (singleThreadNanoseconds * threadsCount / result.getMedianNanoseconds()) << "x" << std::endl;
+    }
+}
+
+
+/// Throughput of `convert` in samples/ns, and of `reduce` vs. `reduceScalar` in words/ns (`samples_per_ns` / `words_per_ns` metrics).
+void benchmarkUniformRangeReducer(benchmark::Runner& runner, const uint32_t sourceRange, const uint32_t destinationRange, const size_t samplesCount) {
+    const auto samples = generateSamples(sourceRange, samplesCount, 42);
+    auto reducer = UniformRangeReducer(sourceRange, destinationRange);
+    auto output = std::vector<uint32_t>(std::max(reducer.getMaxOutputCount(samplesCount), samplesCount));
+
+    const auto group = "UniformRangeReducer [0, " + std::to_string(sourceRange) + ") -> [0, " + std::to_string(destinationRange) + ")";
+    const auto elementsCount = static_cast<long long>(samplesCount);
+    // A fresh reducer per run: `convert` carries its accumulator over.
+    const auto convertResult = runner.run(group, "convert", elementsCount, [&]() {
+        reducer = UniformRangeReducer(sourceRange, destinationRange);
+    }, [&]() {
+        return reducer.convert(samples.data(), samplesCount, output.data());
+    });
+    runner.addMetrics({{"samples_per_ns", elementsCount / convertResult.getMedianNanoseconds()}});
+
+    // `samples` as words: only the throughput matters here.
+    const auto vectorResult = runner.run(group, "reduce", elementsCount, [&]() {
+        return reducer.reduce(samples.data(), samplesCount, output.data());
+    });
+    runner.addMetrics({{"words_per_ns", elementsCount / vectorResult.getMedianNanoseconds()}});
+    const auto scalarResult = runner.run(group, "reduceScalar", elementsCount, [&]() {
+        return reducer.reduceScalar(samples.data(), samplesCount, output.data());
+    });
+    runner.addMetrics({{"words_per_ns", elementsCount / scalarResult.getMedianNanoseconds()}});
+    std::cout << "    reduce speedup over reduceScalar " << (scalarResult.getMedianNanoseconds() / vectorResult.getMedianNanoseconds()) << "x" << std::endl;
+
+    if (reducer.reduce(samples.data(), samplesCount, output.data()) != reducer.reduceScalar(samples.data(), samplesCount, output.data())) {
+        std::cout << "[Wrong] " << group << ": reduce and reduceScalar output counts differ" << std::endl;
+    }
+}
+
+
+int main() {
+    testXoshiro256StarStar();
+
+    convertRandomNumbersTest("Xoshiro256StarStar", Xoshiro256StarStar(42), 10000000);
+    convertRandomNumbersTest("std::mt19937_64", std::mt19937_64(42), 10000000);
+#if defined(__APPLE__) || defined(__FreeBSD__) || defined(__OpenBSD__)
+    convertRandomNumbersTest("arc4random", Arc4random(), 10000000);
+#endif
+
+    testRunConversion("Xoshiro256StarStar", Xoshiro256StarStar(42), 10000000);
+
+    testUniformRangeReducer(4, 6, 10000000);
+    testUniformRangeReducer(2, 1000, 10000000);
+    testUniformRangeReducer(6, 4, 10000000);
+    testUniformRangeReducer(10, 7, 10000000);
+    testUniformRangeReducer(1000, 1, 1000000);
+    testUniformRangeReducer(4294967295u, 3, 1000000);
+
+    // Threads are started in every run: fewer repetitions.
+    auto runner = benchmark::Runner(benchmark::Options{1, 5, 2});
+    const auto conversionsCount = static_cast<int>(benchmark::scaled(10000000));
+    benchmarkConvertRandomNumbers(runner, "Xoshiro256StarStar", Xoshiro256StarStar(42), conversionsCount);
+    benchmarkConvertRandomNumbers(runner, "std::mt19937_64", std::mt19937_64(42), conversionsCount);
+#if defined(__APPLE__) || defined(__FreeBSD__) || defined(__OpenBSD__)
+    benchmarkConvertRandomNumbers(runner, "arc4random", Arc4random(), conversionsCount);
+#endif
+    benchmarkConversionScaling(runner, "Xoshiro256StarStar", Xoshiro256StarStar(42), conversionsCount);
+    benchmarkUniformRangeReducer(runner, 4, 6, benchmark::scaled(100000000));
+    benchmarkUniformRangeReducer(runner, 6, 1000, benchmark::scaled(100000000));
+    runner.writeFromEnvironment();
 
     return 0;
-}
\ No newline at end of file
+}
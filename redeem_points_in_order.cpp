@@ -14,8 +14,17 @@
 
 #include <iostream>
 #include <vector>
+#include <cstdint>
+#include <random>
+#include <algorithm>
+#include <utility>    // std::pair
+#include <thread>
+#include <stdexcept>
+#include <cmath>
 
+#include "helpers/Barrier.hpp"
 #include "helpers/Operators.hpp"
+#include "helpers/Benchmark.hpp"
 
 
 #pragma mark - 1. Choose middle segment first
@@ -64,6 +73,376 @@ public:
 };
 
 
+#pragma mark - 2. Rolling array
+/*
+ * Same DP as 1, but each segment length only reads the previous length's row: keep 2 rows instead of the n*n table.
+ *
+ * Notes:
+ * - O(n) memory.
+ * - Accumulate in `int64_t`: `int` overflows on long cards.
+ * - The inner loop has no branches and no loop-carried dependency, so it vectorizes across `index1`.
+ */
+class Solution2 {
+public:
+    int64_t maxPoints(const std::vector<int>& multipliers, const std::vector<int>& prices) {
+        if (multipliers.empty()) {
+            return 0;
+        }
+
+        const size_t n = multipliers.size();
+
+        // `previousRow[index1]`: best points of the segment of the previous length that starts at `index1`.
+        auto previousRow = std::vector<int64_t>(n);
+        auto currentRow = std::vector<int64_t>(n);
+
+        // Length 1 segments: they take the last price.
+        const int64_t lastPrice = prices[prices.size() - 1];
+        for (size_t index1 = 0; index1 < n; index1 += 1) {
+            previousRow[index1] = lastPrice * multipliers[index1];
+        }
+
+        // Longer segments.
+        for (size_t segmentLength = 2; segmentLength <= n; segmentLength += 1) {
+            const int64_t currentPrice = prices[prices.size() - segmentLength];
+
+            const int64_t* previous = previousRow.data();
+            int64_t* current = currentRow.data();
+            const int* front = multipliers.data();
+            const int* back = multipliers.data() + segmentLength - 1;
+
+            const size_t segmentsCount = n - segmentLength + 1;
+            for (size_t index1 = 0; index1 < segmentsCount; index1 += 1) {
+                const int64_t value1 = previous[index1 + 1] + currentPrice * front[index1];
+                const int64_t value2 = previous[index1] + currentPrice * back[index1];
+                current[index1] = std::max(value1, value2);
+            }
+
+            std::swap(previousRow, currentRow);
+        }
+
+        return previousRow.front();
+    }
+};
+
+
+#pragma mark - 3. Multi-threaded wavefront
+enum class RedeemFrom {
+    front,
+    back,
+};
+
+std::ostream& operator << (std::ostream& os, const RedeemFrom& redeemFrom) {
+    os << ((redeemFrom == RedeemFrom::front)? "F": "B");
+    return os;
+}
+
+
+/*
+ * Within one segment length, every `index1` cell is independent: split `index1` into one contiguous range per thread.
+ *
+ * Syncing once per length costs n barriers. Instead, each sync covers a tile of `tileDepth` lengths in 2 phases:
+ * - Phase 1: each thread computes the cells that only depend on its own range. The range shrinks by 1 on the right per length (cell `index1` reads `index1 + 1` of the previous length).
+ * - Phase 2: each thread fills the triangle on its right edge, which also reads the first cell of its right neighbor (computed in phase 1).
+ *
+ * Notes:
+ * - Rows are a ring of `tileDepth + 1` rolling arrays: O(tileDepth * n) memory for points.
+ * - The choice of each cell is kept as 1 bit (n^2 / 2 bits in total) to rebuild the redemption sequence.
+ * - Ranges are aligned to 64 cells so that threads never share a choice word.
+ */
+class Solution3 {
+private:
+    static constexpr size_t CHOICE_WORD_BITS = 64;
+
+private:
+    /// `rows[segmentLength % rows.size()]`
+    std::vector<std::vector<int64_t>> rows;
+    /// `choices[segmentLength]`: bit `index1` is set if that segment redeems its back multiplier first.
+    std::vector<std::vector<uint64_t>> choices;
+
+public:
+    /**
+     * @return Maximum points and the multiplier redeemed for each purchase, in order.
+     */
+    std::pair<int64_t, std::vector<RedeemFrom>> maxPoints(const std::vector<int>& multipliers, const std::vector<int>& prices, size_t threadsCount, size_t tileDepth = 32) {
+        if (multipliers.empty()) {
+            return {0, {}};
+        }
+
+        const size_t n = multipliers.size();
+
+        // Ranges are multiples of 64 cells, and a tile must not be deeper than a range.
+        const size_t wordsCount = (n + CHOICE_WORD_BITS - 1) / CHOICE_WORD_BITS;
+        threadsCount = std::max<size_t>(1, std::min(threadsCount, wordsCount));
+        const size_t rangeLength = ((wordsCount + threadsCount - 1) / threadsCount) * CHOICE_WORD_BITS;
+        tileDepth = std::max<size_t>(1, std::min(tileDepth, rangeLength));
+
+        rows = std::vector<std::vector<int64_t>>(tileDepth + 1, std::vector<int64_t>(n));
+        choices = std::vector<std::vector<uint64_t>>(n + 1);
+        for (size_t segmentLength = 2; segmentLength <= n; segmentLength += 1) {
+            choices[segmentLength] = std::vector<uint64_t>((n - segmentLength + 1 + CHOICE_WORD_BITS - 1) / CHOICE_WORD_BITS, 0);
+        }
+
+        auto barrier = Barrier(threadsCount);
+
+        auto worker = [&](const size_t threadIndex) {
+            // [rangeBegin, rangeEnd)
+            const size_t rangeBegin = std::min(n, threadIndex * rangeLength);
+            const size_t rangeEnd = std::min(n, rangeBegin + rangeLength);
+            // The last range has no right neighbor: it's only bounded by the segments count.
+            const bool isLastRange = (threadIndex == (threadsCount - 1));
+
+            // Length 1 segments: they take the last price.
+            const int64_t lastPrice = prices.back();
+            auto& firstRow = rows[1 % rows.size()];
+            for (size_t index1 = rangeBegin; index1 < rangeEnd; index1 += 1) {
+                firstRow[index1] = lastPrice * multipliers[index1];
+            }
+            barrier.wait();
+
+            // Longer segments, `tileDepth` lengths per tile.
+            for (size_t tileBegin = 2; tileBegin <= n; tileBegin += tileDepth) {
+                const size_t tileEnd = std::min(n + 1, tileBegin + tileDepth);
+
+                // Phase 1: shrinking trapezoid inside the current range.
+                for (size_t segmentLength = tileBegin; segmentLength < tileEnd; segmentLength += 1) {
+                    const size_t segmentsCount = n - segmentLength + 1;
+                    const size_t depth = segmentLength - tileBegin;
+
+                    const size_t end = isLastRange? segmentsCount: std::min(rangeEnd - depth, segmentsCount);
+                    computeCells(multipliers, prices, segmentLength, rangeBegin, end);
+                }
+                barrier.wait();
+
+                // Phase 2: growing triangle on the right edge, reading the right neighbor's phase 1 cells.
+                if (!isLastRange) {
+                    for (size_t segmentLength = tileBegin + 1; segmentLength < tileEnd; segmentLength += 1) {
+                        const size_t segmentsCount = n - segmentLength + 1;
+                        const size_t depth = segmentLength - tileBegin;
+
+                        computeCells(multipliers, prices, segmentLength, std::max(rangeBegin, rangeEnd - depth), std::min(rangeEnd, segmentsCount));
+                    }
+                }
+                barrier.wait();
+            }
+        };
+
+        auto allThreads = std::vector<std::thread>();
+        for (size_t threadIndex = 1; threadIndex < threadsCount; threadIndex += 1) {
+            allThreads.emplace_back(worker, threadIndex);
+        }
+        worker(0);    // The current thread also does some work.
+        for (auto& aThread: allThreads) {
+            aThread.join();
+        }
+
+        const int64_t points = rows[n % rows.size()][0];
+        auto sequence = getSequence(n);
+
+        // Release the memory.
+        rows.clear();
+        choices.clear();
+
+        return {points, std::move(sequence)};
+    }
+
+private:
+    /// Computes segments [begin, end) of `segmentLength` from the previous length's row.
+    void computeCells(const std::vector<int>& multipliers, const std::vector<int>& prices, const size_t segmentLength, const size_t begin, const size_t end) {
+        const int64_t currentPrice = prices[prices.size() - segmentLength];
+
+        const int64_t* previous = rows[(segmentLength - 1) % rows.size()].data();
+        int64_t* current = rows[segmentLength % rows.size()].data();
+        const int* front = multipliers.data();
+        const int* back = multipliers.data() + segmentLength - 1;
+        uint64_t* choiceWords = choices[segmentLength].data();
+
+        // Build each choice word in a register, then write it once.
+        size_t index1 = begin;
+        while (index1 < end) {
+            const size_t wordIndex = index1 / CHOICE_WORD_BITS;
+            const size_t wordEnd = std::min(end, (wordIndex + 1) * CHOICE_WORD_BITS);
+
+            uint64_t word = 0;
+            for (; index1 < wordEnd; index1 += 1) {
+                const int64_t value1 = previous[index1 + 1] + currentPrice * front[index1];
+                const int64_t value2 = previous[index1] + currentPrice * back[index1];
+                current[index1] = std::max(value1, value2);
+                word |= static_cast<uint64_t>(value2 > value1) << (index1 % CHOICE_WORD_BITS);
+            }
+            choiceWords[wordIndex] |= word;
+        }
+    }
+
+    /// Walks the choices from the whole card (first purchase) down to a single multiplier (last purchase).
+    std::vector<RedeemFrom> getSequence(const size_t n) const {
+        auto returnValue = std::vector<RedeemFrom>();
+        returnValue.reserve(n);
+
+        size_t index1 = 0;
+        for (size_t segmentLength = n; segmentLength >= 2; segmentLength -= 1) {
+            const bool isBack = (choices[segmentLength][index1 / CHOICE_WORD_BITS] >> (index1 % CHOICE_WORD_BITS)) & 1;
+            if (isBack) {
+                returnValue.push_back(RedeemFrom::back);
+            } else {
+                returnValue.push_back(RedeemFrom::front);
+                index1 += 1;
+            }
+        }
+        returnValue.push_back(RedeemFrom::front);    // Only 1 multiplier left.
+
+        return returnValue;
+    }
+};
+
+
+#pragma mark - 4. Batch
+/*
+ * Scores many price lists against the same multiplier card.
+ *
+ * Customers are processed in blocks of `LANES_COUNT`, laid out as a structure of arrays (`[index][lane]`).
+ * Every DP step is then the same operation over `LANES_COUNT` contiguous customers, which vectorizes.
+ *
+ * Notes:
+ * - Uses the rolling array of solution 2: O(n * LANES_COUNT) memory per block.
+ * - The last block is padded with 0 prices; its padding lanes are discarded.
+ * - Pays off on short cards with many customers. On long cards, a block's rows no longer fit in L1 and solution 2 per customer is as fast.
+ */
+class BatchSolution {
+private:
+    static constexpr size_t LANES_COUNT = 16;
+
+private:
+    const std::vector<int> multipliers;
+
+public:
+    explicit BatchSolution(std::vector<int> multipliers): multipliers(std::move(multipliers)) {}
+
+public:
+    std::vector<int64_t> maxPoints(const std::vector<std::vector<int>>& priceLists) const {
+        auto returnValue = std::vector<int64_t>(priceLists.size());
+        maxPoints(priceLists, returnValue.data());
+        return returnValue;
+    }
+
+    /**
+     * @param output Receives `priceLists.size()` results, in order.
+     */
+    void maxPoints(const std::vector<std::vector<int>>& priceLists, int64_t* output) const {
+        const size_t n = multipliers.size();
+        for (const auto& prices: priceLists) {
+            if (prices.size() != n) {
+                throw std::invalid_argument("Every price list must have as many purchases as there are multipliers.");
+            }
+        }
+
+        if (n == 0) {
+            std::fill(output, output + priceLists.size(), 0);
+            return;
+        }
+
+        auto blockPrices = std::vector<int>(n * LANES_COUNT);
+        auto previousRow = std::vector<int64_t>(n * LANES_COUNT);
+        auto currentRow = std::vector<int64_t>(n * LANES_COUNT);
+
+        for (size_t blockBegin = 0; blockBegin < priceLists.size(); blockBegin += LANES_COUNT) {
+            const size_t lanesUsed = std::min(LANES_COUNT, priceLists.size() - blockBegin);
+
+            // Transpose this block's prices.
+            std::fill(blockPrices.begin(), blockPrices.end(), 0);
+            for (size_t lane = 0; lane < lanesUsed; lane += 1) {
+                const auto& prices = priceLists[blockBegin + lane];
+                for (size_t priceIndex = 0; priceIndex < n; priceIndex += 1) {
+                    blockPrices[priceIndex * LANES_COUNT + lane] = prices[priceIndex];
+                }
+            }
+
+            // Length 1 segments: they take the last price.
+            const int* lastPrices = blockPrices.data() + (n - 1) * LANES_COUNT;
+            for (size_t index1 = 0; index1 < n; index1 += 1) {
+                const int64_t multiplier = multipliers[index1];
+                int64_t* cells = previousRow.data() + index1 * LANES_COUNT;
+                for (size_t lane = 0; lane < LANES_COUNT; lane += 1) {
+                    cells[lane] = static_cast<int64_t>(lastPrices[lane]) * multiplier;
+                }
+            }
+
+            // Longer segments.
+            for (size_t segmentLength = 2; segmentLength <= n; segmentLength += 1) {
+                const int* currentPrices = blockPrices.data() + (n - segmentLength) * LANES_COUNT;
+
+                const size_t segmentsCount = n - segmentLength + 1;
+                for (size_t index1 = 0; index1 < segmentsCount; index1 += 1) {
+                    const int64_t frontMultiplier = multipliers[index1];
+                    const int64_t backMultiplier = multipliers[index1 + segmentLength - 1];
+
+                    const int64_t* previousFront = previousRow.data() + (index1 + 1) * LANES_COUNT;
+                    const int64_t* previousBack = previousRow.data() + index1 * LANES_COUNT;
+                    int64_t* current = currentRow.data() + index1 * LANES_COUNT;
+
+                    for (size_t lane = 0; lane < LANES_COUNT; lane += 1) {
+                        // Both factors fit in 32 bits: a widening multiply is enough.
+                        const int64_t value1 = previousFront[lane] + static_cast<int64_t>(currentPrices[lane]) * frontMultiplier;
+                        const int64_t value2 = previousBack[lane] + static_cast<int64_t>(currentPrices[lane]) * backMultiplier;
+                        current[lane] = std::max(value1, value2);
+                    }
+                }
+
+                std::swap(previousRow, currentRow);
+            }
+
+            std::copy(previousRow.begin(), previousRow.begin() + lanesUsed, output + blockBegin);
+        }
+    }
+};
+
+
+#pragma mark - Tests
+/// Replays a redemption sequence and returns its points.
+int64_t redeem(const std::vector<int>& multipliers, const std::vector<int>& prices, const std::vector<RedeemFrom>& sequence) {
+    int64_t returnValue = 0;
+
+    size_t front = 0;
+    size_t back = multipliers.size() - 1;
+    for (size_t i = 0; i < sequence.size(); i += 1) {
+        if (sequence[i] == RedeemFrom::front) {
+            returnValue += static_cast<int64_t>(prices[i]) * multipliers[front];
+            front += 1;
+        } else {
+            returnValue += static_cast<int64_t>(prices[i]) * multipliers[back];
+            back -= 1;
+        }
+    }
+
+    return returnValue;
+}
+
+
+void testMultiThreaded(const std::vector<int>& multipliers, const std::vector<int>& prices, const int64_t expectedResult, const size_t threadsCount, const size_t tileDepth) {
+    static auto solution3Instance = Solution3();
+    auto [result, sequence] = solution3Instance.maxPoints(multipliers, prices, threadsCount, tileDepth);
+    const auto replayedResult = redeem(multipliers, prices, sequence);
+
+    const bool printVectors = (multipliers.size() <= 16);
+    if ((result == expectedResult) && (replayedResult == expectedResult) && (sequence.size() == multipliers.size())) {
+        std::cout << "[Correct] (" << threadsCount << " threads, tile " << tileDepth << ") ";
+        if (printVectors) {
+            std::cout << multipliers << " " << prices << " " << sequence << ": ";
+        } else {
+            std::cout << "n = " << multipliers.size() << ": ";
+        }
+        std::cout << result << std::endl;
+    } else {
+        std::cout << "[Wrong] (" << threadsCount << " threads, tile " << tileDepth << ") ";
+        if (printVectors) {
+            std::cout << multipliers << " " << prices << " " << sequence << ": ";
+        } else {
+            std::cout << "n = " << multipliers.size() << ": ";
+        }
+        std::cout << result << ", replayed " << replayedResult << " (should be " << expectedResult << ")" << std::endl;
+    }
+}
+
+
 void test(const std::vector<int>& multipliers, const std::vector<int>& prices, const int expectedResult) {
     static auto solutionInstance = Solution();
 
@@ -76,6 +455,120 @@ void test(const std::vector<int>& multipliers, const std::vector<int>& prices, c
     } else {
         std::cout << "[Wrong] " << multipliers << " " << prices << ": " << result << " (should be " << expectedResult << ")" << std::endl;
     }
+
+    static auto solution2Instance = Solution2();
+    auto result2 = solution2Instance.maxPoints(multipliers, prices);
+
+    if (result2 == expectedResult) {
+        std::cout << "[Correct] (rolling array) " << multipliers << " " << prices << ": " << result2 << std::endl;
+    } else {
+        std::cout << "[Wrong] (rolling array) " << multipliers << " " << prices << ": " << result2 << " (should be " << expectedResult << ")" << std::endl;
+    }
+
+    testMultiThreaded(multipliers, prices, expectedResult, 1, 32);
+    testMultiThreaded(multipliers, prices, expectedResult, 4, 2);
+}
+
+
+std::vector<int> generateRandomVector(const size_t length, const int minValue, const int maxValue, std::mt19937& generator) {
+    auto distribution = std::uniform_int_distribution<>(minValue, maxValue);
+
+    auto returnValue = std::vector<int>(length);
+    std::generate(returnValue.begin(), returnValue.end(), [&]() {
+        return distribution(generator);
+    });
+
+    return returnValue;
+}
+
+
+void testBatch(const size_t n, const size_t customersCount, std::mt19937& generator) {
+    const auto multipliers = generateRandomVector(n, -50, 1000, generator);
+    auto priceLists = std::vector<std::vector<int>>();
+    for (size_t i = 0; i < customersCount; i += 1) {
+        priceLists.push_back(generateRandomVector(n, 1, 100000, generator));
+    }
+
+    const auto results = BatchSolution(multipliers).maxPoints(priceLists);
+
+    size_t wrongCount = 0;
+    for (size_t i = 0; i < customersCount; i += 1) {
+        if (results[i] != Solution2().maxPoints(multipliers, priceLists[i])) {
+            wrongCount += 1;
+        }
+    }
+
+    if (wrongCount == 0) {
+        std::cout << "[Correct] (batch) n = " << n << ", " << customersCount << " customers" << std::endl;
+    } else {
+        std::cout << "[Wrong] (batch) n = " << n << ", " << customersCount << " customers: " << wrongCount << " wrong results" << std::endl;
+    }
+}
+
+
+#pragma mark - Benchmark
+/**
+ * Throughput of `Solution2::maxPoints`, per DP cell.
+ *
+ * Run `benchmarkRollingArray(runner, 100000)` for the n = 10^5 figure (5 * 10^9 cells).
+ */
+void benchmarkRollingArray(benchmark::Runner& runner, const size_t n) {
+    auto generator = std::mt19937(42);
+    const auto multipliers = generateRandomVector(n, 1, 1000, generator);
+    const auto prices = generateRandomVector(n, 1, 100000, generator);
+
+    const auto cellsCount = static_cast<long long>(n) * static_cast<long long>(n + 1) / 2;
+    runner.run("redeem n = " + std::to_string(n), "Solution2 (rolling array)", cellsCount, [&]() {
+        return Solution2().maxPoints(multipliers, prices);
+    });
+}
+
+
+void benchmarkMultiThreaded(benchmark::Runner& runner, const size_t n, const size_t maxThreadsCount) {
+    auto generator = std::mt19937(42);
+    const auto multipliers = generateRandomVector(n, 1, 1000, generator);
+    const auto prices = generateRandomVector(n, 1, 100000, generator);
+
+    const auto cellsCount = static_cast<long long>(n) * static_cast<long long>(n + 1) / 2;
+    for (size_t threadsCount = 1; threadsCount <= maxThreadsCount; threadsCount *= 2) {
+        runner.run("redeem n = " + std::to_string(n), "Solution3 (wavefront, " + std::to_string(threadsCount) + " threads)", cellsCount, [&]() {
+            return Solution3().maxPoints(multipliers, prices, threadsCount).first;
+        });
+    }
+}
+
+
+/// Batch API vs calling `Solution2::maxPoints` per customer.
+void benchmarkBatch(benchmark::Runner& runner, const size_t n, const size_t customersCount) {
+    auto generator = std::mt19937(42);
+    const auto multipliers = generateRandomVector(n, 1, 1000, generator);
+    auto priceLists = std::vector<std::vector<int>>();
+    for (size_t i = 0; i < customersCount; i += 1) {
+        priceLists.push_back(generateRandomVector(n, 1, 100000, generator));
+    }
+
+    auto solvePerCustomer = [&]() {
+        int64_t checksum = 0;
+        for (const auto& prices: priceLists) {
+            checksum += Solution2().maxPoints(multipliers, prices);
+        }
+        return checksum;
+    };
+    auto solveBatch = [&]() {
+        int64_t checksum = 0;
+        for (const auto& result: BatchSolution(multipliers).maxPoints(priceLists)) {
+            checksum += result;
+        }
+        return checksum;
+    };
+
+    const auto group = "redeem batch, n = " + std::to_string(n);
+    runner.run(group, "Solution2 per customer", static_cast<long long>(customersCount), solvePerCustomer);
+    runner.run(group, "BatchSolution", static_cast<long long>(customersCount), solveBatch);
+
+    if (solvePerCustomer() != solveBatch()) {
+        std::cout << "[Wrong] " << group << ", " << customersCount << " customers: BatchSolution differs from Solution2" << std::endl;
+    }
 }
 
 
@@ -84,6 +577,36 @@ int main() {
     test({1, 2, 3, 4}, {5, 10, 8, 9}, 88);
     test({4, 8, 1, 3}, {3, 8, 13, 9}, 3 * 3 + 8 * 1 + 13 * 8 + 9 * 4);
     test({4, 8, 1, 3, 1}, {1, 3, 8, 13, 9}, 1 * 1 + 3 * 3 + 8 * 1 + 13 * 8 + 9 * 4);
+    test({7}, {6}, 42);
+
+    // Random cases across range boundaries and tile depths.
+    auto generator = std::mt19937(7);
+    for (const size_t n: {63, 64, 65, 200, 1000}) {
+        const auto multipliers = generateRandomVector(n, -50, 1000, generator);
+        const auto prices = generateRandomVector(n, 1, 100000, generator);
+        const auto expectedResult = Solution2().maxPoints(multipliers, prices);
+
+        for (const size_t threadsCount: {2, 3, 7}) {
+            for (const size_t tileDepth: {1, 5, 64}) {
+                testMultiThreaded(multipliers, prices, expectedResult, threadsCount, tileDepth);
+            }
+        }
+    }
+
+    for (const size_t n: {0, 1, 2, 17, 300}) {
+        for (const size_t customersCount: {0, 1, 15, 16, 33}) {
+            testBatch(n, customersCount, generator);
+        }
+    }
+
+    auto runner = benchmark::Runner(benchmark::Options{1, 5, 2});
+    // Cells grow as n^2: scale n by the square root.
+    const auto n = static_cast<size_t>(20000 * std::sqrt(benchmark::getScale())) + 1;
+    benchmarkRollingArray(runner, n);
+    benchmarkBatch(runner, 1000, benchmark::scaled(2000));
+    benchmarkBatch(runner, 20, benchmark::scaled(500000));
+    benchmarkMultiThreaded(runner, n, 4);
+    runner.writeFromEnvironment();
 
     return 0;
 }
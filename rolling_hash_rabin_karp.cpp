@@ -11,8 +11,32 @@
 #include <chrono>
 #include <random>
 #include <algorithm>
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+#include <map>
+#include <utility>    // std::pair
+#include <cstring>
+#include <cerrno>
+#include <cstdio>
+#include <thread>
+#include <atomic>
+#include <array>
+#include <stdexcept>
+#include <cmath>
+#include <functional>    // std::boyer_moore_searcher
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
 
 #include "helpers/terminal_format.h"
+#include "helpers/Benchmark.hpp"
 
 
 #pragma mark - 1. No hash overflow protection
@@ -124,32 +148,158 @@ public:
 };
 
 
+#pragma mark - 3. Precomputed power, 64-bit modulus
+/*
+ * Moduli for `HasherV3`. Each one packs its hash into a `uint64_t` and provides branch-free modular arithmetic.
+ */
+
+/// 2^61 - 1: a prime, so a collision is about 1 in 2^61 per window. The reduction only needs shifts and adds.
+struct Mersenne61Modulus {
+    static const uint64_t MOD = (1ULL << 61) - 1;
+
+    static uint64_t reduce(const uint64_t x) {
+        // Valid for x < 2 * MOD: subtract `MOD` without branching.
+        const uint64_t y = x - MOD;
+        return y + (MOD & (0 - (y >> 63)));
+    }
+
+    static uint64_t fromInteger(const uint64_t x) {
+        return x % MOD;
+    }
+
+    static uint64_t add(const uint64_t a, const uint64_t b) {
+        return reduce(a + b);
+    }
+
+    static uint64_t subtract(const uint64_t a, const uint64_t b) {
+        return reduce(a + MOD - b);
+    }
+
+    static uint64_t multiply(const uint64_t a, const uint64_t b) {
+        const __uint128_t product = static_cast<__uint128_t>(a) * b;
+        // 2^61 == 1 (mod 2^61 - 1): fold the high bits onto the low bits.
+        const uint64_t folded = (static_cast<uint64_t>(product) & MOD) + static_cast<uint64_t>(product >> 61);
+        return reduce(folded);
+    }
+};
+
+
+/// 2 independent 32-bit prime moduli, packed as (hash1 << 32) | hash2. Avoids 128-bit products.
+template <uint32_t MOD1 = 1000000007, uint32_t MOD2 = 998244353>
+struct DoubleModulus32 {
+    static uint64_t pack(const uint64_t hash1, const uint64_t hash2) {
+        return (hash1 << 32) | hash2;
+    }
+
+    static uint64_t reduce(const uint64_t x, const uint64_t mod) {
+        // Valid for x < 2 * mod.
+        const uint64_t y = x - mod;
+        return y + (mod & (0 - (y >> 63)));
+    }
+
+    static uint64_t fromInteger(const uint64_t x) {
+        return pack(x % MOD1, x % MOD2);
+    }
+
+    static uint64_t add(const uint64_t a, const uint64_t b) {
+        return pack(reduce((a >> 32) + (b >> 32), MOD1), reduce((a & UINT32_MAX) + (b & UINT32_MAX), MOD2));
+    }
+
+    static uint64_t subtract(const uint64_t a, const uint64_t b) {
+        return pack(reduce((a >> 32) + MOD1 - (b >> 32), MOD1), reduce((a & UINT32_MAX) + MOD2 - (b & UINT32_MAX), MOD2));
+    }
+
+    static uint64_t multiply(const uint64_t a, const uint64_t b) {
+        return pack(((a >> 32) * (b >> 32)) % MOD1, ((a & UINT32_MAX) * (b & UINT32_MAX)) % MOD2);
+    }
+};
+
+
+/*
+ * BASE^(maxLength - 1) is computed once in the constructor, so each slide is O(1) instead of O(maxLength) in `HasherV2`.
+ *
+ * Notes:
+ * - `BASE` must be smaller than every modulus.
+ * - Characters are hashed as unsigned bytes.
+ */
+template <uint64_t BASE = 1000003, typename Modulus = Mersenne61Modulus>
+class HasherV3 {
+private:
+    int length;
+    int maxLength;
+
+private:
+    const uint64_t base;
+    /// BASE^(maxLength - 1): the weight of the outgoing character.
+    uint64_t outgoingPower;
+
+    uint64_t currentHash;
+
+public:
+    HasherV3(int maxLength): length(0), maxLength(maxLength), base(Modulus::fromInteger(BASE)), outgoingPower(Modulus::fromInteger(1)), currentHash(0) {
+        for (int i = 0; i < (maxLength - 1); i += 1) {
+            outgoingPower = Modulus::multiply(outgoingPower, base);
+        }
+    }
+
+public:
+    [[nodiscard]] uint64_t getHash() const {
+        return currentHash;
+    }
+
+    void updateCharacter(char nextCharacter) {
+        if (length == maxLength) {
+            throw std::runtime_error("Enough initial characters. Call `int updateCharacter(char, char)` instead.");
+        }
+
+        currentHash = Modulus::add(Modulus::multiply(currentHash, base), Modulus::fromInteger(static_cast<unsigned char>(nextCharacter)));
+
+        length += 1;
+    }
+
+    void updateCharacter(char previousCharacter, char nextCharacter) {
+        if (length != maxLength) {
+            throw std::runtime_error("Not enough initial characters. Call `int updateCharacter(char)` instead.");
+        }
+
+        const auto previousHashDelta = Modulus::multiply(Modulus::fromInteger(static_cast<unsigned char>(previousCharacter)), outgoingPower);
+        currentHash = Modulus::subtract(currentHash, previousHashDelta);
+
+        currentHash = Modulus::add(Modulus::multiply(currentHash, base), Modulus::fromInteger(static_cast<unsigned char>(nextCharacter)));
+    }
+};
+
+
+using HasherMersenne61 = HasherV3<1000003, Mersenne61Modulus>;
+using HasherDoubleModulus32 = HasherV3<1000003, DoubleModulus32<>>;
+
+
 #pragma mark - Find
+/// Compares the window at `position` with `needle`, after their hashes matched.
+inline bool isSameWindow(const std::string& haystack, const size_t position, const std::string& needle) {
+    return std::memcmp(haystack.data() + position, needle.data(), needle.size()) == 0;
+}
+
+
+template <typename Hasher = HasherMersenne61>
 int findWithRollingHash(const std::string& haystack, const std::string& needle) {
-    auto needleHasher = HasherV2(needle.size());
+    if (needle.size() > haystack.size()) {
+        return -1;
+    }
+
+    auto needleHasher = Hasher(needle.size());
     for (const auto& c: needle) {
         needleHasher.updateCharacter(c);
     }
     const auto needleHash = needleHasher.getHash();
 
     // First few characters.
-    auto haystackHasher = HasherV2(needle.size());
+    auto haystackHasher = Hasher(needle.size());
     for (size_t left = 0; left < needle.size(); left += 1) {
         haystackHasher.updateCharacter(haystack[left]);
     }
-    if (haystackHasher.getHash() == needleHash) {
-        // Compare.
-        bool same = true;
-        for (size_t i = 0; i < needle.size(); i += 1) {
-            if (haystack[i] != needle[i]) {
-                same = false;
-                break;
-            }
-        }
-
-        if (same) {
-            return 0;
-        }
+    if ((haystackHasher.getHash() == needleHash) && isSameWindow(haystack, 0, needle)) {
+        return 0;
     }
 
     // Upcoming characters.
@@ -157,18 +307,186 @@ int findWithRollingHash(const std::string& haystack, const std::string& needle)
         const size_t left = right - needle.size();
 
         haystackHasher.updateCharacter(haystack[left], haystack[right]);
-        if (haystackHasher.getHash() == needleHash) {
-            // Compare.
-            bool same = true;
-            for (size_t i = 0; i < needle.size(); i += 1) {
-                if (haystack[i + left + 1] != needle[i]) {
-                    same = false;
-                    break;
+        if ((haystackHasher.getHash() == needleHash) && isSameWindow(haystack, left + 1, needle)) {
+            return (left + 1);
+        }
+    }
+
+    return -1;
+}
+
+
+#pragma mark - Find (first and last byte filter)
+/*
+ * A window can only match if its first byte equals `needle.front()` and its last byte equals `needle.back()`.
+ * With AVX2, both bytes are compared for 32 windows at once, and only the surviving windows are verified with `memcmp`.
+ *
+ * Without AVX2, this falls back to `findWithRollingHash`.
+ */
+int findWithFirstLastByteFilter(const std::string& haystack, const std::string& needle) {
+    const size_t m = needle.size();
+    const size_t n = haystack.size();
+    if (m == 0) {
+        return 0;
+    } else if (m > n) {
+        return -1;
+    }
+
+#if defined(__AVX2__)
+    const char* data = haystack.data();
+    const __m256i firstBytes = _mm256_set1_epi8(needle.front());
+    const __m256i lastBytes = _mm256_set1_epi8(needle.back());
+
+    // Windows [left, left + 32) at a time. Their last bytes end at `left + 32 + m - 1`.
+    size_t left = 0;
+    for (; (left + 32 + m - 1) <= n; left += 32) {
+        const __m256i windowFirstBytes = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + left));
+        const __m256i windowLastBytes = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + left + m - 1));
+        const __m256i candidates = _mm256_and_si256(_mm256_cmpeq_epi8(windowFirstBytes, firstBytes), _mm256_cmpeq_epi8(windowLastBytes, lastBytes));
+
+        // 1 bit per window.
+        auto mask = static_cast<uint32_t>(_mm256_movemask_epi8(candidates));
+        while (mask != 0) {
+            const size_t position = left + __builtin_ctz(mask);
+            // The first and last bytes already match.
+            if (std::memcmp(data + position + 1, needle.data() + 1, (m >= 2)? (m - 2): 0) == 0) {
+                return static_cast<int>(position);
+            }
+            mask &= (mask - 1);    // Clear the lowest bit.
+        }
+    }
+
+    // Remaining windows, fewer than 32.
+    for (; (left + m) <= n; left += 1) {
+        if ((data[left] == needle.front()) && (data[left + m - 1] == needle.back()) && (std::memcmp(data + left, needle.data(), m) == 0)) {
+            return static_cast<int>(left);
+        }
+    }
+
+    return -1;
+#else
+    return findWithRollingHash(haystack, needle);
+#endif
+}
+
+
+#pragma mark - Find (two-way)
+/*
+ * Crochemore–Perrin two-way string matching: O(n + m) time and O(1) extra space, with no bad case.
+ *
+ * https://en.wikipedia.org/wiki/Two-way_string-matching_algorithm
+ *
+ * The needle is split at a critical factorization (computed from its maximal suffixes) `needle[0, ell]` + `needle[ell + 1, m)`.
+ * Each window is compared right part first (left to right), then left part (right to left).
+ */
+namespace two_way {
+    /**
+     * Maximal suffix of `x` for `<` (`reversed == false`) or `>` (`reversed == true`).
+     *
+     * @param period Receives the period of that suffix.
+     * @return The index before the suffix starts (-1 means the whole string).
+     */
+    inline ptrdiff_t getMaximalSuffix(const std::string& x, const bool reversed, ptrdiff_t& period) {
+        const auto m = static_cast<ptrdiff_t>(x.size());
+
+        ptrdiff_t maximalSuffix = -1;
+        ptrdiff_t j = 0;
+        ptrdiff_t k = 1;
+        period = 1;
+
+        while ((j + k) < m) {
+            const auto a = static_cast<unsigned char>(x[j + k]);
+            const auto b = static_cast<unsigned char>(x[maximalSuffix + k]);
+
+            if (reversed? (a > b): (a < b)) {
+                // The suffix continues, with a longer period.
+                j += k;
+                k = 1;
+                period = j - maximalSuffix;
+            } else if (a == b) {
+                if (k != period) {
+                    k += 1;
+                } else {
+                    j += period;
+                    k = 1;
+                }
+            } else {
+                // A new maximal suffix starts at `j`.
+                maximalSuffix = j;
+                j = maximalSuffix + 1;
+                k = 1;
+                period = 1;
+            }
+        }
+
+        return maximalSuffix;
+    }
+}
+
+
+int findWithTwoWay(const std::string& haystack, const std::string& needle) {
+    const auto m = static_cast<ptrdiff_t>(needle.size());
+    const auto n = static_cast<ptrdiff_t>(haystack.size());
+    if (m == 0) {
+        return 0;
+    } else if (m > n) {
+        return -1;
+    }
+
+    // Critical factorization: the later of the 2 maximal suffixes.
+    ptrdiff_t period1 = 0;
+    ptrdiff_t period2 = 0;
+    const auto suffix1 = two_way::getMaximalSuffix(needle, false, period1);
+    const auto suffix2 = two_way::getMaximalSuffix(needle, true, period2);
+    const auto ell = std::max(suffix1, suffix2);
+    auto period = (suffix1 > suffix2)? period1: period2;
+
+    if (std::memcmp(needle.data(), needle.data() + period, ell + 1) == 0) {
+        // Periodic needle: remember how much of the left part already matched after a shift by `period`.
+        ptrdiff_t memory = -1;
+        for (ptrdiff_t j = 0; j <= (n - m);) {
+            ptrdiff_t i = std::max(ell, memory) + 1;
+            while ((i < m) && (needle[i] == haystack[i + j])) {
+                i += 1;
+            }
+
+            if (i >= m) {
+                i = ell;
+                while ((i > memory) && (needle[i] == haystack[i + j])) {
+                    i -= 1;
+                }
+                if (i <= memory) {
+                    return static_cast<int>(j);
                 }
+
+                j += period;
+                memory = m - period - 1;
+            } else {
+                j += i - ell;
+                memory = -1;
+            }
+        }
+    } else {
+        // Non-periodic needle: a safe shift is larger than either part.
+        period = std::max(ell + 1, m - ell - 1) + 1;
+        for (ptrdiff_t j = 0; j <= (n - m);) {
+            ptrdiff_t i = ell + 1;
+            while ((i < m) && (needle[i] == haystack[i + j])) {
+                i += 1;
             }
 
-            if (same) {
-                return (left + 1);
+            if (i >= m) {
+                i = ell;
+                while ((i >= 0) && (needle[i] == haystack[i + j])) {
+                    i -= 1;
+                }
+                if (i < 0) {
+                    return static_cast<int>(j);
+                }
+
+                j += period;
+            } else {
+                j += i - ell;
             }
         }
     }
@@ -177,79 +495,1296 @@ int findWithRollingHash(const std::string& haystack, const std::string& needle)
 }
 
 
-#pragma mark - Tests
-void test(const std::string& haystack, const std::string& needle, const int expectedResult) {
-    auto result = findWithRollingHash(haystack, needle);
+#pragma mark - Find (dispatcher)
+/// Needles up to this length use the byte filter: verification is short, and 32 windows are rejected at once.
+static const size_t FIRST_LAST_BYTE_FILTER_MAX_NEEDLE_LENGTH = 64;
 
-    if (result == expectedResult) {
-        std::cout << terminal_format::OK_GREEN << "[Correct] " << terminal_format::ENDC << haystack << ", " << needle << ": " << result << std::endl;
+/**
+ * Picks a search algorithm by needle length:
+ * - 1 byte: `memchr`.
+ * - Short needles: first and last byte filter (rolling hash without AVX2).
+ * - Long needles: two-way. Repetitive haystacks can make the filter verify a long needle at every window; two-way stays linear.
+ */
+int findFast(const std::string& haystack, const std::string& needle) {
+    if (needle.empty()) {
+        return 0;
+    } else if (needle.size() > haystack.size()) {
+        return -1;
+    }
+
+    if (needle.size() == 1) {
+        const void* match = std::memchr(haystack.data(), needle.front(), haystack.size());
+        return match? static_cast<int>(static_cast<const char*>(match) - haystack.data()): -1;
+    } else if (needle.size() <= FIRST_LAST_BYTE_FILTER_MAX_NEEDLE_LENGTH) {
+        return findWithFirstLastByteFilter(haystack, needle);
     } else {
-        std::cout << terminal_format::FAIL << terminal_format::BOLD << "[Wrong] " << terminal_format::ENDC << haystack << ", " << needle << ": " << result << " (should be " << expectedResult << ")" << std::endl;
+        return findWithTwoWay(haystack, needle);
     }
 }
 
 
-std::string generateRandomString(const int length) {
-    std::string chars = "0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz";
+#pragma mark - Find all (multiple needles)
+/*
+ * Searches many needles in a single pass over the haystack.
+ *
+ * - Needles are grouped by length. Each distinct length keeps 1 rolling hash over the haystack.
+ * - Each group stores its needles' hashes in an open-addressing table (linear probing, power-of-2 size, at most half full).
+ * - Every window whose hash is in the table is compared with the needle to rule out collisions.
+ *
+ * Notes:
+ * - Empty needles are ignored.
+ * - Duplicate needles are all reported.
+ */
+template <typename Hasher = HasherMersenne61>
+class MultiPatternFinder {
+private:
+    struct Slot {
+        uint64_t hash;
+        /// `EMPTY_SLOT` if this slot is unused.
+        uint32_t needleIndex;
+    };
 
-    auto seed = std::chrono::high_resolution_clock::now().time_since_epoch().count();
-    auto generator = std::default_random_engine(seed);
-    auto distribution = std::uniform_int_distribution<>(0, chars.size() - 1);
+    static const uint32_t EMPTY_SLOT = UINT32_MAX;
 
-    auto returnValue = std::string(length, 0);
-    std::generate_n(returnValue.begin(), length, [&chars, &generator, &distribution]() {
-        const auto index = distribution(generator);
-        return chars[index];
-    });
-//    std::cout << returnValue << std::endl;
+    struct LengthGroup {
+        size_t length;
+        std::vector<Slot> slots;
+        /// `slots.size() - 1`
+        size_t mask;
+    };
 
-    return returnValue;
-}
+private:
+    std::vector<std::string> needles;
+    std::vector<LengthGroup> groups;
 
+public:
+    explicit MultiPatternFinder(std::vector<std::string> needles): needles(std::move(needles)) {
+        // Length -> needle indices.
+        auto needlesByLength = std::map<size_t, std::vector<uint32_t>>();
+        for (size_t i = 0; i < this->needles.size(); i += 1) {
+            if (!this->needles[i].empty()) {
+                needlesByLength[this->needles[i].size()].push_back(static_cast<uint32_t>(i));
+            }
+        }
 
-void testHashValue(const int needleLength, const int prefixLength) {
-    auto needle = generateRandomString(needleLength);
-    auto strWithPrefix = generateRandomString(prefixLength) + needle;
+        for (const auto& [length, needleIndices]: needlesByLength) {
+            auto group = LengthGroup();
+            group.length = length;
 
-    auto needleHasher = HasherV2(needleLength);
-    for (const char& c: needle) {
-        needleHasher.updateCharacter(c);
+            size_t slotsCount = 2;
+            while (slotsCount < (needleIndices.size() * 2)) {
+                slotsCount *= 2;
+            }
+            group.slots = std::vector<Slot>(slotsCount, Slot{0, EMPTY_SLOT});
+            group.mask = slotsCount - 1;
+
+            for (const auto& needleIndex: needleIndices) {
+                auto hasher = Hasher(length);
+                for (const auto& c: this->needles[needleIndex]) {
+                    hasher.updateCharacter(c);
+                }
+                const uint64_t hash = hasher.getHash();
+
+                size_t slotIndex = getSlotIndex(hash, group.mask);
+                while (group.slots[slotIndex].needleIndex != EMPTY_SLOT) {
+                    slotIndex = (slotIndex + 1) & group.mask;
+                }
+                group.slots[slotIndex] = Slot{hash, needleIndex};
+            }
+
+            groups.push_back(std::move(group));
+        }
     }
 
-    auto strHasher = HasherV2(needleLength);
-    for (size_t i = 0; i < needleLength; i += 1) {
-        strHasher.updateCharacter(strWithPrefix[i]);
+public:
+    /**
+     * @param callback Called as `callback(position, needleIndex)` for every match, as soon as its last character is read:
+     *                 in increasing order of match end (`position` + needle length), shorter needles first for the same end.
+     *                 Positions are not sorted across needle lengths.
+     */
+    template <typename Callback>
+    void findAll(const std::string& haystack, Callback&& callback) const {
+        auto hashers = std::vector<Hasher>();
+        for (const auto& group: groups) {
+            hashers.emplace_back(group.length);
+        }
+
+        for (size_t right = 0; right < haystack.size(); right += 1) {
+            for (size_t groupIndex = 0; groupIndex < groups.size(); groupIndex += 1) {
+                const auto& group = groups[groupIndex];
+                auto& hasher = hashers[groupIndex];
+
+                if (right < group.length) {
+                    // First few characters.
+                    hasher.updateCharacter(haystack[right]);
+                    if ((right + 1) < group.length) {
+                        continue;
+                    }
+                } else {
+                    hasher.updateCharacter(haystack[right - group.length], haystack[right]);
+                }
+
+                const size_t left = right + 1 - group.length;
+                const uint64_t hash = hasher.getHash();
+
+                // Probe until an empty slot: equal hashes may be spread over several slots.
+                for (size_t slotIndex = getSlotIndex(hash, group.mask); group.slots[slotIndex].needleIndex != EMPTY_SLOT; slotIndex = (slotIndex + 1) & group.mask) {
+                    const auto& slot = group.slots[slotIndex];
+                    if ((slot.hash == hash) && (haystack.compare(left, group.length, needles[slot.needleIndex]) == 0)) {
+                        callback(left, static_cast<size_t>(slot.needleIndex));
+                    }
+                }
+            }
+        }
     }
-    for (size_t i = needleLength; i < strWithPrefix.size(); i += 1) {
-        strHasher.updateCharacter(strWithPrefix[i - needleLength], strWithPrefix[i]);
+
+private:
+    static size_t getSlotIndex(const uint64_t hash, const size_t mask) {
+        // Fibonacci hashing: spreads the hash's bits before masking.
+        return static_cast<size_t>((hash * 0x9E3779B97F4A7C15ULL) >> 32) & mask;
     }
+};
 
-    if (needleHasher.getHash() == strHasher.getHash()) {
-        std::cout << terminal_format::OK_GREEN << "[Correct] " << terminal_format::ENDC << needle << ", " << strWithPrefix << ": " << needleHasher.getHash() << std::endl;
-    } else {
-        std::cout << terminal_format::FAIL << terminal_format::BOLD << "[Wrong] " << terminal_format::ENDC << needle << ", " << strWithPrefix << ": " << strHasher.getHash() << " (should be " << needleHasher.getHash() << ")" << std::endl;
+
+#pragma mark - Find all (streaming)
+/*
+ * Scans input that arrives in chunks, e.g. a file larger than RAM.
+ *
+ * Between chunks, it keeps the hash state and the last `needle.size()` bytes:
+ * - The outgoing character of the first windows in a chunk is in these bytes.
+ * - A window across a chunk boundary is verified against these bytes plus the start of the new chunk.
+ */
+template <typename Hasher = HasherMersenne61>
+class StreamingFinder {
+private:
+    const std::string needle;
+    uint64_t needleHash;
+
+    Hasher hasher;
+    /// Last `needle.size()` bytes (or fewer at the beginning) before the current chunk.
+    std::string tail;
+    /// Total bytes fed so far.
+    size_t consumedCount = 0;
+
+public:
+    explicit StreamingFinder(std::string needle): needle(std::move(needle)), needleHash(0), hasher(this->needle.size()) {
+        if (this->needle.empty()) {
+            throw std::runtime_error("The needle must not be empty.");
+        }
+
+        auto needleHasher = Hasher(this->needle.size());
+        for (const auto& c: this->needle) {
+            needleHasher.updateCharacter(c);
+        }
+        needleHash = needleHasher.getHash();
+    }
+
+public:
+    /**
+     * Scans the next chunk. Nothing is copied except the last `needle.size()` bytes.
+     *
+     * @param callback Called as `callback(offset)` with the absolute offset of every match.
+     */
+    template <typename Callback>
+    void feed(const char* data, const size_t size, Callback&& callback) {
+        const size_t m = needle.size();
+
+        // Windows whose outgoing character is in `tail`.
+        const size_t boundaryEnd = std::min(size, m);
+        for (size_t j = 0; j < boundaryEnd; j += 1) {
+            if (consumedCount < m) {
+                hasher.updateCharacter(data[j]);
+            } else {
+                hasher.updateCharacter(tail[tail.size() - m + j], data[j]);
+            }
+            consumedCount += 1;
+
+            if ((consumedCount >= m) && (static_cast<uint64_t>(hasher.getHash()) == needleHash)) {
+                // The first `tailLength` bytes of this window are in `tail`.
+                const size_t tailLength = m - (j + 1);
+                if ((tail.compare(tail.size() - tailLength, tailLength, needle, 0, tailLength) == 0) && (std::memcmp(data, needle.data() + tailLength, j + 1) == 0)) {
+                    callback(consumedCount - m);
+                }
+            }
+        }
+
+        // Windows entirely in this chunk.
+        for (size_t j = boundaryEnd; j < size; j += 1) {
+            hasher.updateCharacter(data[j - m], data[j]);
+
+            if (static_cast<uint64_t>(hasher.getHash()) == needleHash) {
+                if (std::memcmp(data + j + 1 - m, needle.data(), m) == 0) {
+                    callback(consumedCount + j + 1 - boundaryEnd - m);
+                }
+            }
+        }
+        consumedCount += size - boundaryEnd;
+
+        // Keep the last `m` bytes.
+        if (size >= m) {
+            tail.assign(data + size - m, m);
+        } else {
+            tail.append(data, size);
+            if (tail.size() > m) {
+                tail.erase(0, tail.size() - m);
+            }
+        }
+    }
+};
+
+
+/**
+ * Reads `fd` with `read()` in chunks of `chunkSize` bytes.
+ *
+ * @param callback Called as `callback(offset)` with the offset of every match from the current file position.
+ */
+template <typename Hasher = HasherMersenne61, typename Callback>
+void findAllInFileDescriptor(const int fd, const std::string& needle, Callback&& callback, const size_t chunkSize = (1 << 20)) {
+    auto finder = StreamingFinder<Hasher>(needle);
+    auto buffer = std::vector<char>(chunkSize);
+
+    while (true) {
+        const auto readCount = read(fd, buffer.data(), buffer.size());
+        if (readCount < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            throw std::runtime_error(std::string("read() failed: ") + std::strerror(errno));
+        } else if (readCount == 0) {
+            // End of file.
+            break;
+        }
+
+        finder.feed(buffer.data(), static_cast<size_t>(readCount), callback);
     }
 }
 
 
-#pragma mark - Main
-int main() {
-    // Overflow test cases.
-    test("aaaaaacccccuuuuu", "aaaaaccccc", 1);
-    test("AAAAAACCCCCUUUUU", "AAAAACCCCC", 1);
-    test("AAAAAAAAAACCCCCUUUUU", "AAAAACCCCC", 5);
-
-    test("aacc", "acc", 1);
-    test("cbR536vk8", "cbR", 0);
-    test("536vk8cbR", "cbR", 6);
-    test("abracadabra", "abra", 0);
-    test("abracadabra", "cad", 4);
-    test("abracadabra", "dab", 6);
-    test("abracadabra", "cda", -1);
+/**
+ * Maps the whole of `fd` read-only and scans it in place: no copy into user space.
+ *
+ * @param callback Called as `callback(offset)` with the absolute offset of every match.
+ */
+template <typename Hasher = HasherMersenne61, typename Callback>
+void findAllInMappedFile(const int fd, const std::string& needle, Callback&& callback) {
+    struct stat fileStatus = {};
+    if (fstat(fd, &fileStatus) != 0) {
+        throw std::runtime_error(std::string("fstat() failed: ") + std::strerror(errno));
+    }
 
-    for (int i = 0; i < 40; i += 1) {
-        testHashValue(3, 1);
+    auto finder = StreamingFinder<Hasher>(needle);
+
+    const auto fileSize = static_cast<size_t>(fileStatus.st_size);
+    if (fileSize == 0) {
+        // `mmap` rejects 0 length.
+        return;
+    }
+
+    void* mapping = mmap(nullptr, fileSize, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (mapping == MAP_FAILED) {
+        throw std::runtime_error(std::string("mmap() failed: ") + std::strerror(errno));
     }
+    // Only a hint: read-ahead more aggressively.
+    madvise(mapping, fileSize, MADV_SEQUENTIAL);
+
+    finder.feed(static_cast<const char*>(mapping), fileSize, callback);
+
+    munmap(mapping, fileSize);
+}
+
+
+#pragma mark - Find (multi-threaded)
+/*
+ * Splits the window start positions into 1 range per thread.
+ * Each range is scanned with its own hasher, seeded from its first window, and reads `needle.size() - 1` bytes past its end (the overlap).
+ */
+static const size_t CANCELLATION_CHECK_INTERVAL = 4096;
+
+/**
+ * Scans the windows that start in [begin, end).
+ *
+ * @param cancelAfter If not null, stops once the current position is past `*cancelAfter` (checked every `CANCELLATION_CHECK_INTERVAL` windows).
+ * @param onMatch Called as `onMatch(position)`. Returns false to stop scanning.
+ */
+template <typename Hasher, typename OnMatch>
+void findInRange(const std::string& haystack, const std::string& needle, const uint64_t needleHash, const size_t begin, const size_t end, const std::atomic<size_t>* cancelAfter, OnMatch&& onMatch) {
+    if (begin >= end) {
+        return;
+    }
+
+    const size_t m = needle.size();
+
+    // Seed with the first window.
+    auto hasher = Hasher(m);
+    for (size_t i = begin; i < (begin + m); i += 1) {
+        hasher.updateCharacter(haystack[i]);
+    }
+
+    for (size_t left = begin; left < end; left += 1) {
+        if (left != begin) {
+            hasher.updateCharacter(haystack[left - 1], haystack[left + m - 1]);
+        }
+
+        if ((static_cast<uint64_t>(hasher.getHash()) == needleHash) && (std::memcmp(haystack.data() + left, needle.data(), m) == 0)) {
+            if (!onMatch(left)) {
+                return;
+            }
+        }
+
+        if (cancelAfter && (((left - begin) % CANCELLATION_CHECK_INTERVAL) == 0) && (left > cancelAfter->load(std::memory_order_relaxed))) {
+            // Another thread has already found an earlier match.
+            return;
+        }
+    }
+}
+
+
+/// Threads actually used for `windowsCount` windows: at least 1, and no thread without a window.
+size_t getRangesCount(const size_t windowsCount, const size_t threadsCount) {
+    return std::max<size_t>(1, std::min(threadsCount, windowsCount));
+}
+
+
+/// Runs `scanRange(threadIndex, begin, end)` on `getRangesCount(windowsCount, threadsCount)` threads over the window start positions.
+template <typename ScanRange>
+void forEachRange(const size_t windowsCount, size_t threadsCount, ScanRange&& scanRange) {
+    threadsCount = getRangesCount(windowsCount, threadsCount);
+
+    auto allThreads = std::vector<std::thread>();
+    for (size_t threadIndex = 1; threadIndex < threadsCount; threadIndex += 1) {
+        allThreads.emplace_back(scanRange, threadIndex, windowsCount * threadIndex / threadsCount, windowsCount * (threadIndex + 1) / threadsCount);
+    }
+    scanRange(0, 0, windowsCount / threadsCount);    // The current thread also does some work.
+    for (auto& aThread: allThreads) {
+        aThread.join();
+    }
+}
+
+
+template <typename Hasher>
+uint64_t getNeedleHash(const std::string& needle) {
+    auto needleHasher = Hasher(needle.size());
+    for (const auto& c: needle) {
+        needleHasher.updateCharacter(c);
+    }
+    return static_cast<uint64_t>(needleHasher.getHash());
+}
+
+
+/**
+ * First match, like `findWithRollingHash`.
+ *
+ * Each thread stops at its first match, or once it's past the earliest match found by any thread.
+ */
+template <typename Hasher = HasherMersenne61>
+int findWithRollingHashMultiThreaded(const std::string& haystack, const std::string& needle, const size_t threadsCount) {
+    if (needle.empty() || (needle.size() > haystack.size())) {
+        return needle.empty()? 0: -1;
+    }
+
+    const uint64_t needleHash = getNeedleHash<Hasher>(needle);
+    const size_t windowsCount = haystack.size() - needle.size() + 1;
+
+    auto firstMatch = std::atomic<size_t>(SIZE_MAX);
+    forEachRange(windowsCount, threadsCount, [&](const size_t, const size_t begin, const size_t end) {
+        findInRange<Hasher>(haystack, needle, needleHash, begin, end, &firstMatch, [&firstMatch](const size_t position) {
+            // Atomic minimum.
+            auto currentFirstMatch = firstMatch.load();
+            while ((position < currentFirstMatch) && !firstMatch.compare_exchange_weak(currentFirstMatch, position)) {}
+            return false;
+        });
+    });
+
+    return (firstMatch == SIZE_MAX)? -1: static_cast<int>(firstMatch);
+}
+
+
+/// All matches in increasing order.
+template <typename Hasher = HasherMersenne61>
+std::vector<size_t> findAllWithRollingHashMultiThreaded(const std::string& haystack, const std::string& needle, size_t threadsCount) {
+    if (needle.empty() || (needle.size() > haystack.size())) {
+        return {};
+    }
+
+    const uint64_t needleHash = getNeedleHash<Hasher>(needle);
+    const size_t windowsCount = haystack.size() - needle.size() + 1;
+
+    // Ranges are in order, so concatenating their results keeps the positions sorted.
+    auto resultsPerThread = std::vector<std::vector<size_t>>(getRangesCount(windowsCount, threadsCount));
+    forEachRange(windowsCount, threadsCount, [&](const size_t threadIndex, const size_t begin, const size_t end) {
+        auto& results = resultsPerThread[threadIndex];
+        findInRange<Hasher>(haystack, needle, needleHash, begin, end, nullptr, [&results](const size_t position) {
+            results.push_back(position);
+            return true;
+        });
+    });
+
+    auto returnValue = std::vector<size_t>();
+    for (const auto& results: resultsPerThread) {
+        returnValue.insert(returnValue.end(), results.begin(), results.end());
+    }
+    return returnValue;
+}
+
+
+#pragma mark - Content-defined chunking
+/*
+ * Splits a byte stream into variable-size chunks whose boundaries depend on the content, for deduplication.
+ * Inserting or deleting bytes only changes the chunks around the edit.
+ *
+ * FastCDC-style:
+ * - Gear rolling hash: `hash = (hash << 1) + GEAR[byte]`. Only 1 shift and 1 add per byte, and the top bits depend on the last 64 bytes.
+ * - A boundary is where the top bits of the hash are all 0.
+ * - The first `minSize` bytes of a chunk are not hashed (cut-point skipping).
+ * - Normalized chunking: a stricter mask (more bits) before `averageSize` and a looser one after it narrows the size distribution.
+ * - A chunk is always cut at `maxSize`.
+ *
+ * https://www.usenix.org/conference/atc16/technical-sessions/presentation/xia
+ *
+ * Each chunk also gets a 122-bit fingerprint: 2 polynomial hashes of its 32-bit words modulo 2^61 - 1, with different bases (see `Mersenne61Modulus`).
+ * Both start from a nonzero seed, so leading zero words still count: zero-prefixed and all-zero chunks of different lengths differ.
+ * It detects accidental duplicates, but it is not collision-resistant against crafted input.
+ */
+struct ChunkFingerprint {
+    uint64_t hash1;
+    uint64_t hash2;
+
+    bool operator == (const ChunkFingerprint& other) const {
+        return (hash1 == other.hash1) && (hash2 == other.hash2);
+    }
+
+    bool operator < (const ChunkFingerprint& other) const {
+        return (hash1 != other.hash1)? (hash1 < other.hash1): (hash2 < other.hash2);
+    }
+};
+
+
+struct Chunk {
+    /// Offset in the whole stream.
+    size_t offset;
+    size_t length;
+    ChunkFingerprint fingerprint;
+};
+
+
+class ContentDefinedChunker {
+private:
+    static const uint64_t FINGERPRINT_BASE1 = 1000003;
+    static const uint64_t FINGERPRINT_BASE2 = 2654435761;
+    static const uint64_t FINGERPRINT_SEED = 0x1F3D5B79A2C4E6ULL;
+
+private:
+    const size_t minSize;
+    const size_t averageSize;
+    const size_t maxSize;
+
+    /// Used before `averageSize`: 1 more bit than log2(averageSize).
+    uint64_t strictMask;
+    /// Used after `averageSize`: 1 fewer bit than log2(averageSize).
+    uint64_t looseMask;
+
+    std::array<uint64_t, 256> gear;
+
+    /// Boundaries only if false: fingerprinting is slower than finding boundaries.
+    const bool computesFingerprints;
+
+private:
+    // Current chunk.
+    size_t chunkOffset = 0;
+    size_t chunkLength = 0;
+    uint64_t gearHash = 0;
+    ChunkFingerprint fingerprint = {FINGERPRINT_SEED, FINGERPRINT_SEED};
+    /// Fingerprinted 4 bytes at a time: the last 0-3 bytes wait here, little-endian.
+    uint64_t pendingWord = 0;
+    size_t pendingCount = 0;
+
+public:
+    ContentDefinedChunker(const size_t minSize, const size_t averageSize, const size_t maxSize, const bool computesFingerprints = true): minSize(minSize), averageSize(averageSize), maxSize(maxSize), strictMask(0), looseMask(0), gear(), computesFingerprints(computesFingerprints) {
+        if ((minSize == 0) || (minSize >= averageSize) || (averageSize >= maxSize)) {
+            throw std::invalid_argument("Chunk sizes must satisfy 0 < minSize < averageSize < maxSize.");
+        }
+
+        int averageBits = 0;
+        while ((static_cast<size_t>(1) << (averageBits + 1)) <= averageSize) {
+            averageBits += 1;
+        }
+        // Top bits: the low bits of a gear hash only depend on the last few bytes.
+        strictMask = getTopBitsMask(averageBits + 1);
+        looseMask = getTopBitsMask(std::max(averageBits - 1, 1));
+
+        // Fixed seed: the same content must always be cut at the same places.
+        uint64_t state = 0x2545F4914F6CDD1DULL;
+        for (auto& value: gear) {
+            // SplitMix64.
+            state += 0x9E3779B97F4A7C15ULL;
+            uint64_t z = state;
+            z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+            z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+            value = z ^ (z >> 31);
+        }
+    }
+
+public:
+    /**
+     * Scans the next buffer. Chunks may span several buffers.
+     *
+     * @param callback Called as `callback(const Chunk&)` for every completed chunk, in order.
+     */
+    template <typename Callback>
+    void feed(const char* data, const size_t size, Callback&& callback) {
+        const auto* bytes = reinterpret_cast<const unsigned char*>(data);
+
+        size_t i = 0;
+        while (i < size) {
+            const size_t availableCount = size - i;
+
+            size_t consumedCount = 0;
+            bool isBoundary = false;
+            if (chunkLength < minSize) {
+                // Cut-point skipping: no boundary can be here, don't hash.
+                consumedCount = std::min(minSize - chunkLength, availableCount);
+            } else {
+                consumedCount = findBoundary(bytes + i, std::min(maxSize - chunkLength, availableCount), isBoundary);
+            }
+
+            if (computesFingerprints) {
+                updateFingerprint(bytes + i, consumedCount);
+            }
+            chunkLength += consumedCount;
+            i += consumedCount;
+
+            if (isBoundary || (chunkLength == maxSize)) {
+                emitChunk(callback);
+            }
+        }
+    }
+
+    /// Emits the last chunk, if any. Call this once after the last `feed`.
+    template <typename Callback>
+    void finish(Callback&& callback) {
+        if (chunkLength > 0) {
+            emitChunk(callback);
+        }
+    }
+
+private:
+    /**
+     * Rolls the gear hash over at most `limit` bytes.
+     *
+     * @return The number of bytes that belong to the current chunk (including the boundary byte if found).
+     */
+    size_t findBoundary(const unsigned char* bytes, const size_t limit, bool& isBoundary) {
+        uint64_t hash = gearHash;
+        isBoundary = false;
+
+        const size_t strictCount = (chunkLength < averageSize)? std::min(limit, averageSize - chunkLength): 0;
+
+        size_t j = 0;
+        for (; j < strictCount; j += 1) {
+            hash = (hash << 1) + gear[bytes[j]];
+            if ((hash & strictMask) == 0) {
+                isBoundary = true;
+                j += 1;
+                break;
+            }
+        }
+        if (!isBoundary) {
+            for (; j < limit; j += 1) {
+                hash = (hash << 1) + gear[bytes[j]];
+                if ((hash & looseMask) == 0) {
+                    isBoundary = true;
+                    j += 1;
+                    break;
+                }
+            }
+        }
+
+        gearHash = hash;
+        return j;
+    }
+
+    void updateFingerprint(const unsigned char* bytes, const size_t count) {
+        size_t j = 0;
+
+        // Complete the pending word first.
+        while ((pendingCount > 0) && (pendingCount < 4) && (j < count)) {
+            pendingWord |= static_cast<uint64_t>(bytes[j]) << (8 * pendingCount);
+            pendingCount += 1;
+            j += 1;
+        }
+        if (pendingCount == 4) {
+            addFingerprintWord(pendingWord);
+            pendingWord = 0;
+            pendingCount = 0;
+        }
+
+        // 4 bytes per step: a 32-bit word is smaller than the modulus. The 2 hashes are independent dependency chains that run in parallel in the CPU.
+        uint64_t hash1 = fingerprint.hash1;
+        uint64_t hash2 = fingerprint.hash2;
+        for (; (j + 4) <= count; j += 4) {
+            uint32_t word = 0;
+            std::memcpy(&word, bytes + j, 4);
+            hash1 = Mersenne61Modulus::add(Mersenne61Modulus::multiply(hash1, FINGERPRINT_BASE1), word);
+            hash2 = Mersenne61Modulus::add(Mersenne61Modulus::multiply(hash2, FINGERPRINT_BASE2), word);
+        }
+        fingerprint = {hash1, hash2};
+
+        // Keep the rest for the next buffer.
+        for (; j < count; j += 1) {
+            pendingWord |= static_cast<uint64_t>(bytes[j]) << (8 * pendingCount);
+            pendingCount += 1;
+        }
+    }
+
+    void addFingerprintWord(const uint64_t word) {
+        fingerprint.hash1 = Mersenne61Modulus::add(Mersenne61Modulus::multiply(fingerprint.hash1, FINGERPRINT_BASE1), word);
+        fingerprint.hash2 = Mersenne61Modulus::add(Mersenne61Modulus::multiply(fingerprint.hash2, FINGERPRINT_BASE2), word);
+    }
+
+    template <typename Callback>
+    void emitChunk(Callback&& callback) {
+        if (computesFingerprints && (pendingCount > 0)) {
+            // Tag the last partial word with its length: it's still smaller than the modulus.
+            addFingerprintWord(pendingWord | (static_cast<uint64_t>(pendingCount) << 32));
+        }
+        callback(Chunk{chunkOffset, chunkLength, fingerprint});
+
+        chunkOffset += chunkLength;
+        chunkLength = 0;
+        gearHash = 0;
+        fingerprint = {FINGERPRINT_SEED, FINGERPRINT_SEED};
+        pendingWord = 0;
+        pendingCount = 0;
+    }
+
+private:
+    static uint64_t getTopBitsMask(const int bitsCount) {
+        return ~static_cast<uint64_t>(0) << (64 - bitsCount);
+    }
+};
+
+
+#pragma mark - Tests
+template <typename Hasher>
+void test(const std::string& haystack, const std::string& needle, const int expectedResult) {
+    auto result = findWithRollingHash<Hasher>(haystack, needle);
+
+    if (result == expectedResult) {
+        std::cout << terminal_format::OK_GREEN << "[Correct] " << terminal_format::ENDC << haystack << ", " << needle << ": " << result << std::endl;
+    } else {
+        std::cout << terminal_format::FAIL << terminal_format::BOLD << "[Wrong] " << terminal_format::ENDC << haystack << ", " << needle << ": " << result << " (should be " << expectedResult << ")" << std::endl;
+    }
+}
+
+
+std::string generateRandomString(const int length) {
+    std::string chars = "0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz";
+
+    auto seed = std::chrono::high_resolution_clock::now().time_since_epoch().count();
+    auto generator = std::default_random_engine(seed);
+    auto distribution = std::uniform_int_distribution<>(0, chars.size() - 1);
+
+    auto returnValue = std::string(length, 0);
+    std::generate_n(returnValue.begin(), length, [&chars, &generator, &distribution]() {
+        const auto index = distribution(generator);
+        return chars[index];
+    });
+//    std::cout << returnValue << std::endl;
+
+    return returnValue;
+}
+
+
+template <typename Hasher>
+void testHashValue(const int needleLength, const int prefixLength) {
+    auto needle = generateRandomString(needleLength);
+    auto strWithPrefix = generateRandomString(prefixLength) + needle;
+
+    auto needleHasher = Hasher(needleLength);
+    for (const char& c: needle) {
+        needleHasher.updateCharacter(c);
+    }
+
+    auto strHasher = Hasher(needleLength);
+    for (size_t i = 0; i < needleLength; i += 1) {
+        strHasher.updateCharacter(strWithPrefix[i]);
+    }
+    for (size_t i = needleLength; i < strWithPrefix.size(); i += 1) {
+        strHasher.updateCharacter(strWithPrefix[i - needleLength], strWithPrefix[i]);
+    }
+
+    if (needleHasher.getHash() == strHasher.getHash()) {
+        std::cout << terminal_format::OK_GREEN << "[Correct] " << terminal_format::ENDC << needle << ", " << strWithPrefix << ": " << needleHasher.getHash() << std::endl;
+    } else {
+        std::cout << terminal_format::FAIL << terminal_format::BOLD << "[Wrong] " << terminal_format::ENDC << needle << ", " << strWithPrefix << ": " << strHasher.getHash() << " (should be " << needleHasher.getHash() << ")" << std::endl;
+    }
+}
+
+
+/// Matches as sorted (position, needle index) pairs.
+std::vector<std::pair<size_t, size_t>> findAllWithStringFind(const std::string& haystack, const std::vector<std::string>& needles) {
+    auto returnValue = std::vector<std::pair<size_t, size_t>>();
+    for (size_t needleIndex = 0; needleIndex < needles.size(); needleIndex += 1) {
+        if (needles[needleIndex].empty()) {
+            continue;
+        }
+
+        for (auto position = haystack.find(needles[needleIndex]); position != std::string::npos; position = haystack.find(needles[needleIndex], position + 1)) {
+            returnValue.emplace_back(position, needleIndex);
+        }
+    }
+
+    std::sort(returnValue.begin(), returnValue.end());
+    return returnValue;
+}
+
+
+template <typename Hasher>
+void testFindAll(const std::string& haystack, const std::vector<std::string>& needles) {
+    auto result = std::vector<std::pair<size_t, size_t>>();
+    MultiPatternFinder<Hasher>(needles).findAll(haystack, [&result](const size_t position, const size_t needleIndex) {
+        result.emplace_back(position, needleIndex);
+    });
+
+    // Callback order: by match end, then by needle length.
+    const bool isOrdered = std::is_sorted(result.begin(), result.end(), [&needles](const std::pair<size_t, size_t>& lhs, const std::pair<size_t, size_t>& rhs) {
+        const size_t lhsLength = needles[lhs.second].size();
+        const size_t rhsLength = needles[rhs.second].size();
+        return std::make_pair(lhs.first + lhsLength, lhsLength) < std::make_pair(rhs.first + rhsLength, rhsLength);
+    });
+    std::sort(result.begin(), result.end());
+
+    const auto expectedResult = findAllWithStringFind(haystack, needles);
+
+    const bool printHaystack = (haystack.size() <= 32);
+    if (isOrdered && (result == expectedResult)) {
+        std::cout << terminal_format::OK_GREEN << "[Correct] " << terminal_format::ENDC << (printHaystack? haystack: "(random haystack)") << ", " << needles.size() << " needles: " << result.size() << " matches" << std::endl;
+    } else {
+        std::cout << terminal_format::FAIL << terminal_format::BOLD << "[Wrong] " << terminal_format::ENDC << (printHaystack? haystack: "(random haystack)") << ", " << needles.size() << " needles: " << result.size() << " matches (should be " << expectedResult.size() << "), ordered " << isOrdered << std::endl;
+    }
+}
+
+
+/// Matches of a single needle, as sorted positions.
+std::vector<size_t> findAllWithStringFind(const std::string& haystack, const std::string& needle) {
+    auto returnValue = std::vector<size_t>();
+    for (auto position = haystack.find(needle); position != std::string::npos; position = haystack.find(needle, position + 1)) {
+        returnValue.push_back(position);
+    }
+
+    return returnValue;
+}
+
+
+void testStreaming(const std::string& haystack, const std::string& needle) {
+    const auto expectedResult = findAllWithStringFind(haystack, needle);
+
+    auto check = [&haystack, &needle, &expectedResult](const std::string& description, const std::vector<size_t>& result) {
+        const auto shownHaystack = (haystack.size() <= 32)? haystack: "(random haystack)";
+        if (result == expectedResult) {
+            std::cout << terminal_format::OK_GREEN << "[Correct] " << terminal_format::ENDC << "(" << description << ") " << shownHaystack << ", " << needle << ": " << result.size() << " matches" << std::endl;
+        } else {
+            std::cout << terminal_format::FAIL << terminal_format::BOLD << "[Wrong] " << terminal_format::ENDC << "(" << description << ") " << shownHaystack << ", " << needle << ": " << result.size() << " matches (should be " << expectedResult.size() << ")" << std::endl;
+        }
+    };
+
+    // In-memory chunks of various sizes, including smaller than the needle.
+    for (const size_t chunkSize: {static_cast<size_t>(1), static_cast<size_t>(3), needle.size() - 1, needle.size(), needle.size() + 1, static_cast<size_t>(4096)}) {
+        if (chunkSize == 0) {
+            continue;
+        }
+
+        auto result = std::vector<size_t>();
+        auto finder = StreamingFinder<>(needle);
+        for (size_t begin = 0; begin < haystack.size(); begin += chunkSize) {
+            finder.feed(haystack.data() + begin, std::min(chunkSize, haystack.size() - begin), [&result](const size_t offset) {
+                result.push_back(offset);
+            });
+        }
+        check("chunks of " + std::to_string(chunkSize), result);
+    }
+
+    // Files.
+    FILE* file = std::tmpfile();
+    if (!file) {
+        std::cout << terminal_format::FAIL << "[Wrong] " << terminal_format::ENDC << "Cannot create a temporary file." << std::endl;
+        return;
+    }
+    std::fwrite(haystack.data(), 1, haystack.size(), file);
+    std::fflush(file);
+    const int fd = fileno(file);
+
+    auto fdResult = std::vector<size_t>();
+    lseek(fd, 0, SEEK_SET);
+    findAllInFileDescriptor(fd, needle, [&fdResult](const size_t offset) {
+        fdResult.push_back(offset);
+    }, 5);
+    check("fd", fdResult);
+
+    auto mappedResult = std::vector<size_t>();
+    findAllInMappedFile(fd, needle, [&mappedResult](const size_t offset) {
+        mappedResult.push_back(offset);
+    });
+    check("mmap", mappedResult);
+
+    std::fclose(file);
+}
+
+
+void testMultiThreaded(const std::string& haystack, const std::string& needle) {
+    const auto expectedAllMatches = findAllWithStringFind(haystack, needle);
+    const int expectedFirstMatch = expectedAllMatches.empty()? -1: static_cast<int>(expectedAllMatches.front());
+
+    const auto shownHaystack = (haystack.size() <= 32)? haystack: "(random haystack)";
+    // 0 threads runs on the current thread only.
+    for (const size_t threadsCount: {0, 1, 2, 3, 8}) {
+        const auto firstMatch = findWithRollingHashMultiThreaded(haystack, needle, threadsCount);
+        const auto allMatches = findAllWithRollingHashMultiThreaded(haystack, needle, threadsCount);
+
+        if ((firstMatch == expectedFirstMatch) && (allMatches == expectedAllMatches)) {
+            std::cout << terminal_format::OK_GREEN << "[Correct] " << terminal_format::ENDC << "(" << threadsCount << " threads) " << shownHaystack << ", " << needle << ": " << firstMatch << ", " << allMatches.size() << " matches" << std::endl;
+        } else {
+            std::cout << terminal_format::FAIL << terminal_format::BOLD << "[Wrong] " << terminal_format::ENDC << "(" << threadsCount << " threads) " << shownHaystack << ", " << needle << ": " << firstMatch << ", " << allMatches.size() << " matches (should be " << expectedFirstMatch << ", " << expectedAllMatches.size() << ")" << std::endl;
+        }
+    }
+}
+
+
+/// Chunks of `data`, fed in buffers of `bufferSize` bytes.
+std::vector<Chunk> getChunks(const std::string& data, const size_t bufferSize, const size_t minSize, const size_t averageSize, const size_t maxSize) {
+    auto returnValue = std::vector<Chunk>();
+    auto addChunk = [&returnValue](const Chunk& chunk) {
+        returnValue.push_back(chunk);
+    };
+
+    auto chunker = ContentDefinedChunker(minSize, averageSize, maxSize);
+    for (size_t begin = 0; begin < data.size(); begin += bufferSize) {
+        chunker.feed(data.data() + begin, std::min(bufferSize, data.size() - begin), addChunk);
+    }
+    chunker.finish(addChunk);
+
+    return returnValue;
+}
+
+
+void testContentDefinedChunking(const size_t dataSize, const size_t minSize, const size_t averageSize, const size_t maxSize) {
+    const auto data = generateRandomString(static_cast<int>(dataSize));
+    const auto chunks = getChunks(data, 1 << 16, minSize, averageSize, maxSize);
+
+    // Chunks must cover the data contiguously, within the size limits (except the last one).
+    bool isValid = true;
+    size_t expectedOffset = 0;
+    for (size_t i = 0; i < chunks.size(); i += 1) {
+        const auto& chunk = chunks[i];
+        if ((chunk.offset != expectedOffset) || (chunk.length > maxSize) || ((chunk.length < minSize) && (i != (chunks.size() - 1)))) {
+            isValid = false;
+        }
+        expectedOffset += chunk.length;
+    }
+    isValid = isValid && (expectedOffset == data.size());
+
+    // Buffer sizes must not change the chunks.
+    bool isBufferIndependent = true;
+    for (const size_t bufferSize: {1, 7, 4096}) {
+        const auto otherChunks = getChunks(data, bufferSize, minSize, averageSize, maxSize);
+        isBufferIndependent = isBufferIndependent && std::equal(chunks.begin(), chunks.end(), otherChunks.begin(), otherChunks.end(), [](const Chunk& lhs, const Chunk& rhs) {
+            return (lhs.offset == rhs.offset) && (lhs.length == rhs.length) && (lhs.fingerprint == rhs.fingerprint);
+        });
+    }
+
+    // Inserting bytes at the front should only change the first few chunks until boundaries resynchronize.
+    const auto shiftedChunks = getChunks(generateRandomString(100) + data, 1 << 16, minSize, averageSize, maxSize);
+    auto fingerprints = std::vector<ChunkFingerprint>();
+    for (const auto& chunk: chunks) {
+        fingerprints.push_back(chunk.fingerprint);
+    }
+    std::sort(fingerprints.begin(), fingerprints.end());
+    size_t reusedCount = 0;
+    for (const auto& chunk: shiftedChunks) {
+        reusedCount += std::binary_search(fingerprints.begin(), fingerprints.end(), chunk.fingerprint);
+    }
+    const bool isShiftResistant = ((reusedCount + 3 + chunks.size() / 20) >= chunks.size());
+
+    if (isValid && isBufferIndependent && isShiftResistant) {
+        std::cout << terminal_format::OK_GREEN << "[Correct] " << terminal_format::ENDC << "CDC " << minSize << "/" << averageSize << "/" << maxSize << ", " << dataSize << " bytes: " << chunks.size() << " chunks, " << reusedCount << " reused after a shift" << std::endl;
+    } else {
+        std::cout << terminal_format::FAIL << terminal_format::BOLD << "[Wrong] " << terminal_format::ENDC << "CDC " << minSize << "/" << averageSize << "/" << maxSize << ", " << dataSize << " bytes: valid " << isValid << ", buffer independent " << isBufferIndependent << ", " << reusedCount << " of " << chunks.size() << " chunks reused after a shift" << std::endl;
+    }
+}
+
+
+/// Chunks shorter than `minSize` are fingerprinted whole: zero-prefixed and all-zero chunks of different lengths must not collide.
+void testChunkFingerprints() {
+    const auto contents = std::vector<std::string>({
+        std::string(60, 'x'),
+        std::string(4, '\0') + std::string(60, 'x'),
+        std::string(8, '\0') + std::string(60, 'x'),
+        std::string(1, '\0'),
+        std::string(3, '\0'),
+        std::string(4, '\0'),
+        std::string(5, '\0'),
+        std::string(8, '\0'),
+        std::string(64, '\0'),
+        std::string(4, '\0') + "x",
+        "x",
+    });
+
+    auto fingerprints = std::vector<ChunkFingerprint>();
+    for (const auto& content: contents) {
+        const auto chunks = getChunks(content, 1 << 16, 256, 1024, 4096);
+        fingerprints.push_back(chunks.front().fingerprint);
+    }
+    std::sort(fingerprints.begin(), fingerprints.end());
+    const auto distinctCount = static_cast<size_t>(std::unique(fingerprints.begin(), fingerprints.end()) - fingerprints.begin());
+
+    if (distinctCount == contents.size()) {
+        std::cout << terminal_format::OK_GREEN << "[Correct] " << terminal_format::ENDC << "CDC fingerprints of " << contents.size() << " zero-prefixed and all-zero chunks are distinct" << std::endl;
+    } else {
+        std::cout << terminal_format::FAIL << terminal_format::BOLD << "[Wrong] " << terminal_format::ENDC << "CDC fingerprints: " << distinctCount << " distinct of " << contents.size() << std::endl;
+    }
+}
+
+
+#pragma mark - Benchmark
+/// Statistics of a full scan with a rolling hash.
+struct ScanStatistics {
+    size_t hashHitsCount = 0;
+    /// Hash hits whose window is not the needle: collisions.
+    size_t falseVerificationsCount = 0;
+    size_t matchesCount = 0;
+};
+
+/// Scans every window (no early exit) and counts hash hits, collisions and matches.
+template <typename Hasher>
+ScanStatistics scanWithRollingHash(const std::string& haystack, const std::string& needle) {
+    auto returnValue = ScanStatistics();
+    if (needle.empty() || (needle.size() > haystack.size())) {
+        return returnValue;
+    }
+
+    auto needleHasher = Hasher(needle.size());
+    for (const auto& c: needle) {
+        needleHasher.updateCharacter(c);
+    }
+    const auto needleHash = needleHasher.getHash();
+
+    auto haystackHasher = Hasher(needle.size());
+    for (size_t right = 0; right < haystack.size(); right += 1) {
+        if (right < needle.size()) {
+            haystackHasher.updateCharacter(haystack[right]);
+            if ((right + 1) < needle.size()) {
+                continue;
+            }
+        } else {
+            haystackHasher.updateCharacter(haystack[right - needle.size()], haystack[right]);
+        }
+
+        if (haystackHasher.getHash() == needleHash) {
+            returnValue.hashHitsCount += 1;
+            if (isSameWindow(haystack, right + 1 - needle.size(), needle)) {
+                returnValue.matchesCount += 1;
+            } else {
+                returnValue.falseVerificationsCount += 1;
+            }
+        }
+    }
+
+    return returnValue;
+}
+
+
+/**
+ * Benchmarks every hasher and the standard library searchers over all combinations of needle lengths and haystack sizes.
+ *
+ * Hashers' collision counts come from 1 untimed scan, attached to their results as metrics (`matches`, `hash_hits`, `false_verifications`, `false_verifications_per_mb`):
+ * they are written to `BENCHMARK_CSV` / `BENCHMARK_JSON` with the timings.
+ *
+ * Notes:
+ * - Haystacks come from `generateRandomString`. The needle is copied from the middle of the haystack, so there is at least 1 match.
+ * - `HasherV1` is only run up to needle length 8: `int` overflows after that.
+ * - `HasherV2` slides in O(m): it's skipped when m * n exceeds `maxSlowWork`.
+ */
+void benchmarkSearchers(benchmark::Runner& runner, const std::vector<size_t>& needleLengths, const std::vector<size_t>& haystackSizes, const double maxSlowWork = 3e8) {
+    for (const auto& haystackSize: haystackSizes) {
+        const auto haystack = generateRandomString(static_cast<int>(haystackSize));
+
+        for (const auto& needleLength: needleLengths) {
+            if (needleLength > haystackSize) {
+                continue;
+            }
+            const auto needle = haystack.substr((haystackSize - needleLength) / 2, needleLength);
+            const auto group = "search, needle " + std::to_string(needleLength) + ", haystack " + std::to_string(haystackSize);
+
+            auto runHasher = [&](const std::string& searcher, auto scan) {
+                runner.run(group, searcher, static_cast<long long>(haystackSize), [&]() {
+                    return scan(haystack, needle).matchesCount;
+                });
+                const auto statistics = scan(haystack, needle);
+                runner.addMetrics({
+                    {"matches", static_cast<double>(statistics.matchesCount)},
+                    {"hash_hits", static_cast<double>(statistics.hashHitsCount)},
+                    {"false_verifications", static_cast<double>(statistics.falseVerificationsCount)},
+                    {"false_verifications_per_mb", statistics.falseVerificationsCount / (haystackSize / 1e6)},
+                });
+            };
+
+            if (needleLength <= 8) {
+                runHasher("HasherV1", scanWithRollingHash<HasherV1>);
+            }
+            if ((static_cast<double>(needleLength) * haystackSize) <= maxSlowWork) {
+                runHasher("HasherV2", scanWithRollingHash<HasherV2>);
+            }
+            runHasher("HasherMersenne61", scanWithRollingHash<HasherMersenne61>);
+            runHasher("HasherDoubleModulus32", scanWithRollingHash<HasherDoubleModulus32>);
+
+            auto runSearcher = [&](const std::string& searcher, auto findNext) {
+                runner.run(group, searcher, static_cast<long long>(haystackSize), [&]() {
+                    size_t matchesCount = 0;
+                    for (auto position = findNext(0); position != std::string::npos; position = findNext(position + 1)) {
+                        matchesCount += 1;
+                    }
+                    return matchesCount;
+                });
+            };
+
+            runSearcher("std::string::find", [&](const size_t begin) {
+                return haystack.find(needle, begin);
+            });
+
+            const auto boyerMooreSearcher = std::boyer_moore_searcher(needle.begin(), needle.end());
+            runSearcher("std::boyer_moore_searcher", [&](const size_t begin) {
+                const auto match = std::search(haystack.begin() + begin, haystack.end(), boyerMooreSearcher);
+                return (match == haystack.end())? std::string::npos: static_cast<size_t>(match - haystack.begin());
+            });
+        }
+    }
+}
+
+
+/**
+ * Throughput (`gb_per_s` metric; the target is 1+ GB/s per core) and chunk size distribution of `ContentDefinedChunker`, with and without fingerprints.
+ */
+void benchmarkContentDefinedChunking(benchmark::Runner& runner, const size_t dataSize, const size_t minSize, const size_t averageSize, const size_t maxSize) {
+    // `generateRandomString` is too slow for hundreds of MB.
+    auto data = std::string(dataSize, 0);
+    auto generator = std::mt19937_64(42);
+    for (size_t i = 0; i < dataSize; i += 8) {
+        const uint64_t value = generator();
+        std::memcpy(&data[i], &value, std::min<size_t>(8, dataSize - i));
+    }
+
+    const auto group = "CDC " + std::to_string(minSize) + "/" + std::to_string(averageSize) + "/" + std::to_string(maxSize);
+    for (const bool computesFingerprints: {false, true}) {
+        auto lengths = std::vector<size_t>();
+        auto addChunk = [&lengths](const Chunk& chunk) {
+            lengths.push_back(chunk.length);
+        };
+
+        const auto result = runner.run(group, computesFingerprints? "with fingerprints": "boundaries only", static_cast<long long>(dataSize), [&]() {
+            lengths.clear();
+        }, [&]() {
+            auto chunker = ContentDefinedChunker(minSize, averageSize, maxSize, computesFingerprints);
+            chunker.feed(data.data(), data.size(), addChunk);
+            chunker.finish(addChunk);
+            return lengths.size();
+        });
+        runner.addMetrics({{"gb_per_s", dataSize / result.getMedianNanoseconds()}});
+
+        if (computesFingerprints) {
+            continue;
+        }
+
+        double mean = 0;
+        for (const auto& length: lengths) {
+            mean += length;
+        }
+        mean /= lengths.size();
+        double variance = 0;
+        for (const auto& length: lengths) {
+            variance += (length - mean) * (length - mean);
+        }
+        variance /= lengths.size();
+        std::cout << group << ": " << lengths.size() << " chunks, mean " << mean << ", standard deviation " << std::sqrt(variance) << std::endl;
+
+        // Histogram in buckets of `minSize`.
+        auto buckets = std::vector<size_t>(maxSize / minSize + 1, 0);
+        for (const auto& length: lengths) {
+            buckets[length / minSize] += 1;
+        }
+        for (size_t i = 0; i < buckets.size(); i += 1) {
+            if (buckets[i] > 0) {
+                std::cout << "  [" << (i * minSize) << ", " << ((i + 1) * minSize) << "): " << buckets[i] << std::endl;
+            }
+        }
+    }
+}
+
+
+/**
+ * Throughput of the multi-threaded search in GB/s vs thread count (`gb_per_s` metric).
+ *
+ * - All matches: the needle is absent, so the whole haystack is scanned.
+ * - First match: the needle is planted at 3/4 of the haystack, which is the number of bytes counted.
+ */
+void benchmarkMultiThreaded(benchmark::Runner& runner, const int haystackSize, const int needleLength, const size_t maxThreadsCount) {
+    auto haystack = generateRandomString(haystackSize);
+    const auto needle = generateRandomString(needleLength);
+    const auto plantedPosition = static_cast<size_t>(haystackSize) / 4 * 3;
+    auto haystackWithNeedle = haystack;
+    haystackWithNeedle.replace(plantedPosition, needle.size(), needle);
+
+    const auto group = "multi-threaded search, haystack " + std::to_string(haystackSize) + ", needle " + std::to_string(needleLength);
+    for (size_t threadsCount = 1; threadsCount <= maxThreadsCount; threadsCount *= 2) {
+        const auto threads = " (" + std::to_string(threadsCount) + " threads)";
+        const auto allMatchesResult = runner.run(group, "findAllWithRollingHashMultiThreaded" + threads, haystackSize, [&]() {
+            return findAllWithRollingHashMultiThreaded(haystack, needle, threadsCount).size();
+        });
+        // Bytes / ns = GB/s.
+        runner.addMetrics({{"gb_per_s", allMatchesResult.elementsCount / allMatchesResult.getMedianNanoseconds()}});
+        const auto firstMatchResult = runner.run(group, "findWithRollingHashMultiThreaded" + threads, static_cast<long long>(plantedPosition), [&]() {
+            return findWithRollingHashMultiThreaded(haystackWithNeedle, needle, threadsCount);
+        });
+        runner.addMetrics({{"gb_per_s", firstMatchResult.elementsCount / firstMatchResult.getMedianNanoseconds()}});
+    }
+}
+
+
+void testFindFast(const std::string& haystack, const std::string& needle) {
+    const auto position = haystack.find(needle);
+    const int expectedResult = (position == std::string::npos)? -1: static_cast<int>(position);
+
+    const auto filterResult = findWithFirstLastByteFilter(haystack, needle);
+    const auto twoWayResult = findWithTwoWay(haystack, needle);
+    const auto fastResult = findFast(haystack, needle);
+
+    const auto shownHaystack = (haystack.size() <= 32)? haystack: "(random haystack)";
+    const auto shownNeedle = (needle.size() <= 32)? needle: ("(needle of length " + std::to_string(needle.size()) + ")");
+    if ((filterResult == expectedResult) && (twoWayResult == expectedResult) && (fastResult == expectedResult)) {
+        std::cout << terminal_format::OK_GREEN << "[Correct] " << terminal_format::ENDC << shownHaystack << ", " << shownNeedle << ": " << fastResult << std::endl;
+    } else {
+        std::cout << terminal_format::FAIL << terminal_format::BOLD << "[Wrong] " << terminal_format::ENDC << shownHaystack << ", " << shownNeedle << ": filter " << filterResult << ", two-way " << twoWayResult << ", dispatcher " << fastResult << " (should be " << expectedResult << ")" << std::endl;
+    }
+}
+
+
+#pragma mark - Main
+template <typename Hasher>
+void testFind() {
+    // Overflow test cases.
+    test<Hasher>("aaaaaacccccuuuuu", "aaaaaccccc", 1);
+    test<Hasher>("AAAAAACCCCCUUUUU", "AAAAACCCCC", 1);
+    test<Hasher>("AAAAAAAAAACCCCCUUUUU", "AAAAACCCCC", 5);
+
+    test<Hasher>("aacc", "acc", 1);
+    test<Hasher>("cbR536vk8", "cbR", 0);
+    test<Hasher>("536vk8cbR", "cbR", 6);
+    test<Hasher>("abracadabra", "abra", 0);
+    test<Hasher>("abracadabra", "cad", 4);
+    test<Hasher>("abracadabra", "dab", 6);
+    test<Hasher>("abracadabra", "cda", -1);
+    test<Hasher>("ab", "abc", -1);
+}
+
+
+int main() {
+    testFind<HasherV2>();
+    testFind<HasherMersenne61>();
+    testFind<HasherDoubleModulus32>();
+
+    for (int i = 0; i < 40; i += 1) {
+        testHashValue<HasherV2>(3, 1);
+    }
+    testFindAll<HasherMersenne61>("abracadabra", {"abra", "cad", "dab", "cda", "a", "abra", "", "abracadabrax"});
+    testFindAll<HasherMersenne61>("aaaaaa", {"aa", "aaa"});
+    testFindAll<HasherMersenne61>("", {"a"});
+    {
+        // Short alphabet: many matches across lengths.
+        auto generator = std::mt19937(42);
+        auto distribution = std::uniform_int_distribution<>('a', 'c');
+        auto haystack = std::string(20000, 0);
+        std::generate(haystack.begin(), haystack.end(), [&]() { return static_cast<char>(distribution(generator)); });
+
+        auto needles = std::vector<std::string>();
+        for (int i = 0; i < 1000; i += 1) {
+            const size_t length = 1 + i % 12;
+            const size_t position = generator() % (haystack.size() - length);
+            needles.push_back(haystack.substr(position, length));
+            needles.push_back(generateRandomString(length));
+        }
+        testFindAll<HasherMersenne61>(haystack, needles);
+        testFindAll<HasherDoubleModulus32>(haystack, needles);
+    }
+
+    testStreaming("abracadabra", "abra");
+    testStreaming("abracadabra", "a");
+    testStreaming("aaaaaaaaaa", "aaa");
+    testStreaming("", "abc");
+    testStreaming("ab", "abc");
+    {
+        auto needle = generateRandomString(7);
+        auto haystack = std::string();
+        for (int i = 0; i < 200; i += 1) {
+            haystack += generateRandomString(i % 13) + needle;
+        }
+        testStreaming(haystack, needle);
+    }
+
+    for (int i = 0; i < 10; i += 1) {
+        testHashValue<HasherMersenne61>(100, 1000);
+        testHashValue<HasherDoubleModulus32>(100, 1000);
+    }
+
+    for (const auto& [haystack, needle]: std::vector<std::pair<std::string, std::string>>({{"abracadabra", "abra"}, {"abracadabra", "cad"}, {"abracadabra", "cda"}, {"abracadabra", "d"}, {"aaaaaaaaaa", "aaa"}, {"aabaabaabaaab", "aabaaab"}, {"ab", "abc"}, {"abc", ""}})) {
+        testFindFast(haystack, needle);
+    }
+    {
+        // Short alphabet: many partial matches and periodic needles.
+        auto generator = std::mt19937(42);
+        auto distribution = std::uniform_int_distribution<>('a', 'b');
+        auto generateBinaryString = [&](const size_t length) {
+            auto returnValue = std::string(length, 0);
+            std::generate(returnValue.begin(), returnValue.end(), [&]() { return static_cast<char>(distribution(generator)); });
+            return returnValue;
+        };
+
+        for (int i = 0; i < 300; i += 1) {
+            const size_t needleLength = 1 + (generator() % 200);
+            const auto haystack = generateBinaryString(10 + (generator() % 5000));
+            // Either a random needle (likely absent) or one taken from the haystack.
+            auto needle = generateBinaryString(needleLength);
+            if (((i % 2) == 0) && (needleLength < haystack.size())) {
+                needle = haystack.substr(generator() % (haystack.size() - needleLength), needleLength);
+            }
+            testFindFast(haystack, needle);
+        }
+    }
+
+    testMultiThreaded("abracadabra", "abra");
+    testMultiThreaded("abracadabra", "cda");
+    testMultiThreaded("aaaaaaaaaa", "aaa");
+    testMultiThreaded("ab", "abc");
+    {
+        auto needle = generateRandomString(7);
+        auto haystack = std::string();
+        for (int i = 0; i < 200; i += 1) {
+            haystack += generateRandomString(i * 37 % 101) + needle;
+        }
+        testMultiThreaded(haystack, needle);
+    }
+
+    // Large inputs and threads: fewer repetitions.
+    auto runner = benchmark::Runner(benchmark::Options{1, 5, 2});
+    benchmarkMultiThreaded(runner, static_cast<int>(benchmark::scaled(1 << 24)), 16, 8);
+
+    testContentDefinedChunking(1 << 20, 2048, 8192, 65536);
+    testContentDefinedChunking(100000, 64, 256, 1024);
+    testContentDefinedChunking(100, 64, 256, 1024);
+    testChunkFingerprints();
+    benchmarkContentDefinedChunking(runner, benchmark::scaled(1 << 27), 2048, 8192, 65536);
+
+    // Full-size run (takes minutes): benchmarkSearchers(runner, {3, 8, 16, 64, 256, 1024, 4096}, {1 << 20, 1 << 24, 1 << 30});
+    benchmarkSearchers(runner, {3, 8, 64, 4096}, {static_cast<size_t>(benchmark::scaled(1 << 16)), static_cast<size_t>(benchmark::scaled(1 << 20))});
+    runner.writeFromEnvironment();
 
 //    generateRandomString(6);
 
@@ -12,6 +12,10 @@
 #include <fstream>
 #include <sstream>
 #include <algorithm>    // std::find
+#include <random>
+
+#include "helpers/Benchmark.hpp"
+#include "helpers/PerfCounters.hpp"
 
 
 #pragma mark - Helpers
@@ -209,6 +213,8 @@ private:
     }
 
     void calculateNextVertices() {
+        PERF_COUNTERS_SCOPE("Salesman::calculateNextVertices");
+
         previousVertices = std::move(currentVertices);
         resetCurrentVertices();
 
@@ -323,6 +329,32 @@ std::vector<std::vector<unsigned int>> get48CitiesTestCase() {
 }
 
 
+#pragma mark - Benchmark
+/// Symmetric random distances between `citiesCount` cities.
+std::vector<std::vector<unsigned int>> generateRandomDistances(const size_t citiesCount) {
+    auto generator = std::mt19937(42);
+    auto distribution = std::uniform_int_distribution<unsigned int>(1, 1000);
+    auto returnValue = std::vector<std::vector<unsigned int>>(citiesCount, std::vector<unsigned int>(citiesCount, 0));
+    for (size_t i = 0; i < citiesCount; i += 1) {
+        for (size_t j = i + 1; j < citiesCount; j += 1) {
+            returnValue[i][j] = distribution(generator);
+            returnValue[j][i] = returnValue[i][j];
+        }
+    }
+    return returnValue;
+}
+
+
+/// `Salesman` grows factorially: keep `citiesCount` small.
+void benchmarkSalesman(benchmark::Runner& runner, const size_t citiesCount) {
+    const auto distances = generateRandomDistances(citiesCount);
+    runner.run("travelling_salesman", "Salesman", static_cast<long long>(citiesCount), [&]() {
+        auto solutionInstance = Salesman(distances);
+        return solutionInstance.calculate().first;
+    });
+}
+
+
 int main() {
     std::vector<std::vector<unsigned int>> distances1 = {
         {0, 25, 30, 30},
@@ -344,5 +376,13 @@ int main() {
 //    std::vector<std::vector<unsigned int>> distances3 = get48CitiesTestCase();
 //    test(distances3);
 
+    auto runner = benchmark::Runner();
+    for (const size_t citiesCount: {6, 8, 10}) {
+        benchmarkSalesman(runner, citiesCount);
+    }
+    runner.writeFromEnvironment();
+
+    PERF_COUNTERS_REPORT(std::cout);
+
     return 0;
 }